@@ -4,7 +4,8 @@
 /**
  * General-use PID class for drivetrains. It includes both
  * control calculation and settling calculation. The default
- * update period is 10ms or 100Hz.
+ * update period is 10ms or 100Hz. Passing a timestamp to
+ * compute() measures the real period instead of assuming it.
  */
 
 class PID
@@ -25,6 +26,17 @@ public:
   float time_spent_running = 0;
   float update_period = 10;
 
+  // Timestamped mode. Gains stay tuned per update_period, so the
+  // measured dt only rescales the I and D terms.
+  bool use_timestamps = false;
+  uint64_t start_time_us = 0;
+  uint64_t previous_time_us = 0;
+  uint64_t settled_since_us = 0;
+  bool in_settle_band = false;
+  // Derivative low-pass weight in [0, 1). 0 is unfiltered.
+  float derivative_filter = 0;
+  float derivative = 0;
+
 
   // This will be true if flags are used, false if time is used.
   bool use_settle_flags = false; 
@@ -33,6 +45,21 @@ public:
   // The current count of consecutive settled cycles.
   int consecutive_settled_count = 0;
 
+  // Velocity settling. With settle_velocity above 0, the movement is
+  // also settled once it has been in the settle band for
+  // settle_velocity_count ticks in a row and velocity, which the
+  // motion updates every tick, is under settle_velocity. The count
+  // keeps one slow tick on the way through the band from ending it.
+  float settle_velocity = 0;
+  int settle_velocity_count = 3;
+  float velocity = INFINITY;
+
+  // Why is_settled() last returned true, SETTLE_RUNNING until then.
+  uint8_t settle_reason = SETTLE_RUNNING;
+
+  // Record type for this controller's ticks in telemetry.
+  telemetry_type telemetry_source = TELEMETRY_PID_TICK;
+
   PID(float error, float kp, float ki, float kd, float starti);
 
 
@@ -43,5 +70,9 @@ public:
 
   float compute(float error);
 
+  float compute(float error, uint64_t time_us);
+
   bool is_settled();
+
+  void log_config(uint64_t time_us);
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * One profiled step of an auton: a Drive motion, or anything else an
+ * auton brackets with begin() and end(). Times are milliseconds since
+ * the auton started. exit_reason is a settle_state: SETTLE_TIME,
+ * SETTLE_FLAGS or SETTLE_VELOCITY when it settled, SETTLE_TIMEOUT
+ * when it timed out, SETTLE_IN_BAND when it ended inside tolerance
+ * without a settle check (paths), and SETTLE_RUNNING when it was
+ * cancelled or never ended.
+ */
+
+struct AutonStep
+{
+  const char *name;
+  int motion_id;
+  uint32_t start_ms;
+  uint32_t end_ms;
+  uint8_t exit_reason;
+  int settle_count;
+  float start_error;
+  float final_error;
+  float peak_voltage;
+};
+
+/**
+ * Auton timing profiler. Drive records every motion here on its own,
+ * with when it started and ended, why it ended, its error at each end
+ * and the highest drive voltage it asked for. After the auton,
+ * report() prints a table of the steps and the gaps between them
+ * (waits and intake actions), with totals, and saves it as a CSV on
+ * the SD card. Steps are kept in a fixed array, so recording one is
+ * just a few stores.
+ */
+
+class AutonProfiler
+{
+public:
+  static const int max_steps = 64;
+  AutonStep steps[max_steps];
+  int step_count = 0;
+  int dropped = 0;
+  bool running = false;
+  uint32_t start_time = 0;
+  const char *filename = "auton_profile.csv";
+
+  AutonProfiler();
+
+  void start();
+
+  int begin(const char *name, int motion_id, float start_error);
+
+  void end(int step, uint8_t exit_reason, int settle_count, float final_error, float peak_voltage);
+
+  void report();
+
+  void save();
+
+  static const char *exit_name(uint8_t exit_reason);
+};
+
+extern AutonProfiler profiler;
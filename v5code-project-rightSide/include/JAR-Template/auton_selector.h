@@ -0,0 +1,55 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * One entry in the auton registry: the name shown on the Brain and the
+ * function that runs it.
+ */
+
+struct AutonEntry
+{
+  const char *name;
+  void (*run)(void);
+};
+
+/**
+ * Touch-driven auton selector for pre-auton. Tapping the right side of
+ * the Brain screen selects the next auton in the registry and the left
+ * side the previous one. The choice is saved to the SD card, so it
+ * survives a restart, and run() dispatches straight through the
+ * registry. draw() only repaints the fields whose text has changed, so
+ * it costs almost nothing while the IMU calibrates.
+ */
+
+class AutonSelector
+{
+public:
+  static const int field_count = 3;
+  static const int field_length = 32;
+  const AutonEntry *autons;
+  int auton_count;
+  volatile int selection = 0;
+  bool screen_drawn = false;
+  char drawn[field_count][field_length] = {};
+  const char *filename = "auton_select.txt";
+
+  AutonSelector(const AutonEntry *autons, int auton_count);
+
+  void select(int index);
+
+  bool select(const char *name);
+
+  const char *selected_name();
+
+  void load();
+
+  void save();
+
+  void draw();
+
+  void run();
+
+  static void screen_pressed();
+};
+
+extern AutonSelector selector;
@@ -0,0 +1,42 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Battery voltage compensation. Voltage commands are fractions of
+ * whatever the battery is putting out, so the same command runs the
+ * motors slower as the battery drains and as it sags under load.
+ * compensate() treats a command as volts out of 12 on a fully charged
+ * battery and scales it up as the battery's present voltage, read from
+ * Brain.Battery.voltage() through a low-pass filter, drops below that,
+ * so 8 volts gives the same speed on a full battery and a tired one.
+ * Commands are never scaled down, so a full battery still gets full
+ * speed. When the battery can't deliver a command in full it's clamped
+ * to 12, and headroom() says where that limit is so motions can plan
+ * inside it.
+ */
+
+class BatteryCompensation
+{
+public:
+  bool enabled = true;
+  float nominal_voltage = 12.8;
+  // Low-pass time constant in milliseconds, and the shortest time
+  // between battery reads.
+  float filter_time_constant = 200;
+  uint32_t sample_period = 5;
+
+  float filtered_voltage = 0;
+  uint32_t last_sample_time = 0;
+
+  BatteryCompensation();
+
+  void set_nominal_voltage(float nominal_voltage);
+
+  float voltage();
+
+  float compensate(float command);
+
+  float headroom();
+};
+
+extern BatteryCompensation battery;
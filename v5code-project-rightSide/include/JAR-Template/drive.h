@@ -1,10 +1,33 @@
 #pragma once
 #include "vex.h"
 
+class PID;
+
 enum drive_setup {ZERO_TRACKER_NO_ODOM, ZERO_TRACKER_ODOM, TANK_ONE_FORWARD_ENCODER, TANK_ONE_FORWARD_ROTATION, 
 TANK_ONE_SIDEWAYS_ENCODER, TANK_ONE_SIDEWAYS_ROTATION, TANK_TWO_ENCODER, TANK_TWO_ROTATION, 
 HOLONOMIC_TWO_ENCODER, HOLONOMIC_TWO_ROTATION};
 
+/**
+ * Drive sensor readings taken together at the start of a control tick.
+ * Headings are gyro scale-corrected, rotation is continuous and heading
+ * is in [0, 360). Velocities are the drive motors' average in inches
+ * per second and the gyro's turn rate in degrees per second.
+ */
+
+struct DriveSensors
+{
+  uint64_t time_us = 0;
+  float rotation = 0;
+  float heading = 0;
+  float left_position_in = 0;
+  float right_position_in = 0;
+  float forward_velocity = 0;
+  float turn_velocity = 0;
+  float X_position = 0;
+  float Y_position = 0;
+  uint64_t pose_time_us = 0;
+};
+
 /**
  * Drive class supporting tank and holo drive, with or without odom.
  * Eight flavors of odom and six custom motion algorithms.
@@ -26,7 +49,7 @@ private:
   vex:: triport ThreeWire = vex::triport(vex::PORT22);
 
 public: 
-  drive_setup drive_setup = ZERO_TRACKER_NO_ODOM;
+  enum drive_setup drive_setup = ZERO_TRACKER_NO_ODOM;
   motor_group DriveL;
   motor_group DriveR;
   inertial Gyro;
@@ -39,6 +62,14 @@ public:
   encoder E_ForwardTracker;
   encoder E_SidewaysTracker;
 
+  // Driver control goes through these, so held sticks don't resend.
+  MotorCommand DriveL_command{DriveL};
+  MotorCommand DriveR_command{DriveR};
+  MotorCommand DriveLF_command{DriveLF};
+  MotorCommand DriveRF_command{DriveRF};
+  MotorCommand DriveLB_command{DriveLB};
+  MotorCommand DriveRB_command{DriveRB};
+
   float turn_max_voltage;
   float turn_kp;
   float turn_ki;
@@ -76,15 +107,47 @@ public:
   float swing_settle_time;
   float swing_timeout;
 
+  float drive_settle_velocity = 0;
+  float turn_settle_velocity = 0;
+  float swing_settle_velocity = 0;
+
+  float derating = 1;
+
   float boomerang_lead;
   float boomerang_setback;
 
+  float path_lookahead;
+
+  float drive_max_velocity;
+  float drive_max_acceleration;
+  float turn_max_velocity;
+  float turn_max_acceleration;
+
+  Feedforward drive_feedforward;
+  Feedforward turn_feedforward;
+
+  bool profile_s_curve = false;
+
+  const GainSchedule *drive_schedule = nullptr;
+  const GainSchedule *turn_schedule = nullptr;
+  const GainSchedule *swing_schedule = nullptr;
+
+  const JoystickCurve *throttle_curve = nullptr;
+  const JoystickCurve *turn_curve = nullptr;
+
+  LoopTimer control_loop = LoopTimer(10);
+  float derivative_filter = 0;
+
   Drive(enum::drive_setup drive_setup, motor_group DriveL, motor_group DriveR, int gyro_port, float wheel_diameter, float wheel_ratio, float gyro_scale, int DriveLF_port, int DriveRF_port, int DriveLB_port, int DriveRB_port, int ForwardTracker_port, float ForwardTracker_diameter, float ForwardTracker_center_distance, int SidewaysTracker_port, float SidewaysTracker_diameter, float SidewaysTracker_center_distance);
 
   void drive_with_voltage(float leftVoltage, float rightVoltage);
 
   float get_absolute_heading();
 
+  DriveSensors sensors;
+  void sample_sensors();
+  void sample_gyro();
+
   float get_left_position_in();
 
   float get_right_position_in();
@@ -97,18 +160,49 @@ public:
   void set_turn_exit_conditions(float turn_settle_error, float turn_settle_time, float turn_timeout);
   void set_drive_exit_conditions(float drive_settle_error, float drive_settle_time, float drive_timeout);
   void set_swing_exit_conditions(float swing_settle_error, float swing_settle_time, float swing_timeout);
+  void set_settle_velocities(float drive_settle_velocity, float turn_settle_velocity, float swing_settle_velocity);
+  void set_derating(float derating);
+
+  void set_drive_profile(float drive_max_velocity, float drive_max_acceleration);
+  void set_drive_profile(float drive_max_velocity, float drive_max_acceleration, float drive_kv, float drive_ka);
+  void set_turn_profile(float turn_max_velocity, float turn_max_acceleration);
+  void set_turn_profile(float turn_max_velocity, float turn_max_acceleration, float turn_kv, float turn_ka);
+  void set_drive_feedforward(float kS, float kV, float kA);
+  void set_turn_feedforward(float kS, float kV, float kA);
+
+  void set_drive_schedule(const GainSchedule *drive_schedule);
+  void set_turn_schedule(const GainSchedule *turn_schedule);
+  void set_swing_schedule(const GainSchedule *swing_schedule);
+  void set_joystick_curves(const JoystickCurve *throttle_curve, const JoystickCurve *turn_curve);
+  GainPoint drive_gains(float distance);
+  GainPoint turn_gains(float angle);
+  GainPoint swing_gains(float angle);
+
+  void set_loop_period(float loop_period);
+  void set_derivative_filter(float derivative_filter);
 
   void turn_to_angle(float angle);
   void turn_to_angle(float angle, float turn_max_voltage);
-  void turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout);
+  void turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags = 0);
   void turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti, int settle_flags = 0);
 
   void drive_distance(float distance);
   void drive_distance(float distance, float heading);
   void drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage);
-  void drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout);
+  void drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags = 0);
   void drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags = 0);
 
+  void turn_to_angle_profiled(float angle);
+  void turn_to_angle_profiled(float angle, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags = 0);
+
+  void drive_distance_profiled(float distance);
+  void drive_distance_profiled(float distance, float heading);
+  void drive_distance_profiled(float distance, float heading, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags = 0);
+
+  bool characterize_drive();
+  bool characterize_turn();
+  bool characterize(bool turning, float ramp_rate, float ramp_voltage, float step_voltage, float step_time, Feedforward &result);
+
   void left_swing_to_angle(float angle);
   void left_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti, int settle_flags = 0);
   
@@ -116,6 +210,8 @@ public:
   void right_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti, int settle_flags = 0);
   
   Odom odom;
+  // Odom task period in milliseconds, 5 for 200Hz or 1 for 1kHz.
+  float odom_period = 5;
   float get_ForwardTracker_position();
   float get_SidewaysTracker_position();
   void set_coordinates(float X_position, float Y_position, float orientation_deg);
@@ -130,26 +226,58 @@ public:
 
   void drive_to_point(float X_position, float Y_position);
   void drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage);
-  void drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout);
+  void drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags = 0);
   void drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags = 0);
   
   void drive_to_pose(float X_position, float Y_position, float angle);
   void drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage);
   void drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage);
-  void drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout);
+  void drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags = 0);
   void drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags = 0);
   
+  void follow_path(Path &path);
+  void follow_path(Path &path, float lookahead);
+  void follow_path(Path &path, float lookahead, float end_velocity, bool reversed);
+  void follow_path(Path &path, float lookahead, float end_velocity, bool reversed, float max_velocity, float drive_settle_error, float drive_timeout);
+
   void turn_to_point(float X_position, float Y_position);
   void turn_to_point(float X_position, float Y_position, float extra_angle_deg);
-  void turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout);
+  void turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags = 0);
   void turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti, int settle_flags = 0);
   
   void holonomic_drive_to_pose(float X_position, float Y_position);
   void holonomic_drive_to_pose(float X_position, float Y_position, float angle);
   void holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage);
-  void holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout);
+  void holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags = 0);
   void holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags = 0);
 
+  MotionState motion;
+  std::function<void()> motion_command;
+  vex::task motion_task;
+  static int motion_task_entry(void *drive);
+  void begin_motion(const char *name, float start_error);
+  void end_motion(uint8_t exit_reason, int settle_count, float final_error);
+  void end_motion(PID &pid);
+  Motion start_motion(std::function<void()> command);
+
+  Motion turn_to_angle_async(float angle);
+  Motion turn_to_angle_async(float angle, float turn_max_voltage);
+  Motion turn_to_angle_async(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout);
+
+  Motion drive_distance_async(float distance);
+  Motion drive_distance_async(float distance, float heading);
+  Motion drive_distance_async(float distance, float heading, float drive_max_voltage, float heading_max_voltage);
+  Motion drive_distance_async(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout);
+
+  Motion left_swing_to_angle_async(float angle);
+  Motion right_swing_to_angle_async(float angle);
+  Motion drive_to_point_async(float X_position, float Y_position);
+  Motion drive_to_pose_async(float X_position, float Y_position, float angle);
+  Motion turn_to_point_async(float X_position, float Y_position);
+
+  float joystick_voltage(const JoystickCurve *curve, int32_t value);
   void control_arcade();
   void control_tank();
-  void control_holonomic();
\ No newline at end of file
+  void control_holonomic();
+  void invalidate_commands();
+};
\ No newline at end of file
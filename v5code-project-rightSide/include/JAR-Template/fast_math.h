@@ -0,0 +1,25 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Fast single-precision trig for control loops. The sin/cos kernels
+ * reduce to a quarter turn and use short polynomials, staying within
+ * 1e-7 of libm for |x| up to 1e4; atan2 is within 2e-6 radians.
+ * The error limits are checked over every float in range by
+ * `make mathbench`. The batch versions use NEON four lanes at a time
+ * on the V5 brain, and fall back to the scalar versions elsewhere.
+ */
+
+float fast_sin(float x);
+
+float fast_cos(float x);
+
+void fast_sincos(float x, float &sin_x, float &cos_x);
+
+float fast_atan2(float y, float x);
+
+void fast_sincos_batch(const float *x, float *sin_x, float *cos_x, int count);
+
+void reduce_0_to_360_batch(float *angles, int count);
+
+void reduce_negative_180_to_180_batch(float *angles, int count);
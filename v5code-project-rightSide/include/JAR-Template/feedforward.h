@@ -0,0 +1,44 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Simple motor feedforward: the voltage to hold a velocity and
+ * acceleration is kS to break static friction, plus kV per unit of
+ * velocity, plus kA per unit of acceleration. The drive keeps one
+ * for straight-line motion (inches) and one for turning (degrees).
+ */
+
+class Feedforward
+{
+public:
+  float kS = 0;
+  float kV = 0;
+  float kA = 0;
+
+  Feedforward();
+
+  Feedforward(float kS, float kV, float kA);
+
+  float calculate(float velocity, float acceleration);
+
+  float max_velocity(float voltage, float acceleration);
+};
+
+/**
+ * Least-squares fit of a Feedforward from (voltage, velocity,
+ * acceleration) samples. Only running sums are kept, so it can take
+ * samples every tick of a characterization run without storing them.
+ */
+
+class FeedforwardFit
+{
+public:
+  // Normal equations for voltage = kS*sign(v) + kV*v + kA*a.
+  double sums[3][3] = {};
+  double targets[3] = {};
+  int sample_count = 0;
+
+  void add_sample(float voltage, float velocity, float acceleration);
+
+  bool solve(Feedforward &result);
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * One row of a gain schedule: the constants to use for a move of a
+ * given size, in inches for drives or degrees for turns and swings.
+ */
+
+struct GainPoint
+{
+  float size;
+  float max_voltage;
+  float kp;
+  float ki;
+  float kd;
+  float starti;
+  float settle_error;
+  float settle_time;
+};
+
+/**
+ * Gain schedule for one kind of motion. The rows are a constexpr
+ * table sorted by size, so they live in flash, and a lookup
+ * interpolates linearly between the two rows either side of the move
+ * (and holds the end rows beyond them). Speed at the start of the move
+ * counts as extra size: a robot already moving at v needs another
+ * v^2/(2a) to stop, so it gets the gains of the longer move it is
+ * effectively partway through. For example:
+ *
+ * constexpr GainPoint drive_gains[] = {
+ *   // size, maxVoltage, kP, kI, kD, startI, settle_error, settle_time
+ *   {2, 12, 3, 0, 16, 0, 1, 150},
+ *   {24, 12, 1.5, 0, 10, 0, 1.5, 300},
+ * };
+ * constexpr GainSchedule drive_schedule(drive_gains);
+ * static_assert(drive_schedule.is_sorted(), "drive_gains out of order");
+ */
+
+class GainSchedule
+{
+public:
+  const GainPoint *points = nullptr;
+  int count = 0;
+
+  constexpr GainSchedule() {}
+
+  template <int N>
+  constexpr GainSchedule(const GainPoint (&points)[N]) :
+    points(points),
+    count(N)
+  {}
+
+  constexpr bool is_sorted() const {
+    for (int i = 1; i < count; i++){
+      if (!(points[i-1].size < points[i].size)){ return false; }
+    }
+    return count > 0;
+  }
+
+  GainPoint lookup(float size, float speed, float max_acceleration) const;
+};
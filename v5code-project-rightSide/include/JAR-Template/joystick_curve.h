@@ -0,0 +1,152 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Joystick response curve, precomputed into a table of voltages for
+ * every stick value from -127 to 127. Curves are built with the
+ * constexpr factories below, so the table is worked out when the
+ * program compiles and sits in flash, and shaping an axis costs one
+ * table read per tick. Each curve takes a deadband in stick counts and
+ * rescales what's left of the stick travel to 0..1 before shaping it,
+ * so output starts from zero at the edge of the deadband and full
+ * stick is 12 volts. For example:
+ *
+ * constexpr JoystickCurve throttle_curve = JoystickCurve::cubic(5, 0.4);
+ * chassis.set_joystick_curves(&throttle_curve, &throttle_curve);
+ */
+
+class JoystickCurve
+{
+public:
+  static const int half_range = 127;
+  float table[2*half_range+1] = {};
+
+  /**
+   * Voltage for a stick value.
+   * 
+   * @param value Stick value, clamped to -127..127.
+   * @return Voltage out of 12.
+   */
+
+  constexpr float voltage(int32_t value) const {
+    if (value > half_range){ value = half_range; }
+    if (value < -half_range){ value = -half_range; }
+    return table[value+half_range];
+  }
+
+  /**
+   * Straight line from the deadband to full stick.
+   * 
+   * @param deadband Stick counts that read as zero.
+   */
+
+  static constexpr JoystickCurve linear(float deadband){
+    JoystickCurve curve;
+    for (int i = 0; i <= half_range; i++){
+      curve.set(i, deadband, stick_fraction(i, deadband));
+    }
+    return curve;
+  }
+
+  /**
+   * Blend of a straight line and a cube, the "expo" on RC radios.
+   * 0 is linear and 1 is a pure cube, which gives the most low speed
+   * resolution.
+   * 
+   * @param deadband Stick counts that read as zero.
+   * @param weight Share of the cube, from 0 to 1.
+   */
+
+  static constexpr JoystickCurve cubic(float deadband, float weight){
+    JoystickCurve curve;
+    for (int i = 0; i <= half_range; i++){
+      float u = stick_fraction(i, deadband);
+      curve.set(i, deadband, (1-weight)*u + weight*u*u*u);
+    }
+    return curve;
+  }
+
+  /**
+   * Exponential curve, output = u*(e^(-t) + (1-e^(-t))*e^(t*(u-1))).
+   * 0 is linear and it gets flatter near the middle as t grows; 1 to 3
+   * is the usual range.
+   * 
+   * @param deadband Stick counts that read as zero.
+   * @param t Curve strength.
+   */
+
+  static constexpr JoystickCurve exponential(float deadband, float t){
+    JoystickCurve curve;
+    float minimum = exp_approx(-t);
+    for (int i = 0; i <= half_range; i++){
+      float u = stick_fraction(i, deadband);
+      curve.set(i, deadband, u*(minimum + (1-minimum)*exp_approx(t*(u-1))));
+    }
+    return curve;
+  }
+
+  /**
+   * Piecewise linear curve through {stick, output} points, both as
+   * fractions from 0 to 1 and in increasing stick order. It's mirrored
+   * for negative stick, and held flat outside the first and last
+   * points.
+   * 
+   * @param points Curve points.
+   * @param deadband Stick counts that read as zero.
+   */
+
+  template <int N>
+  static constexpr JoystickCurve piecewise(const float (&points)[N][2], float deadband){
+    JoystickCurve curve;
+    for (int i = 0; i <= half_range; i++){
+      float u = stick_fraction(i, deadband);
+      float output = points[N-1][1];
+      if (u <= points[0][0]){
+        output = points[0][1];
+      } else {
+        for (int j = 1; j < N; j++){
+          if (u <= points[j][0]){
+            float t = (u-points[j-1][0])/(points[j][0]-points[j-1][0]);
+            output = points[j-1][1] + t*(points[j][1]-points[j-1][1]);
+            break;
+          }
+        }
+      }
+      curve.set(i, deadband, output);
+    }
+    return curve;
+  }
+
+private:
+  static constexpr float stick_fraction(int value, float deadband){
+    return (value-deadband)/(half_range-deadband);
+  }
+
+  constexpr void set(int value, float deadband, float output){
+    if (value < deadband){ output = 0; }
+    if (output < 0){ output = 0; }
+    if (output > 1){ output = 1; }
+    table[half_range-value] = -12*output;
+    table[half_range+value] = 12*output;
+  }
+
+  // e^x without the library, which isn't constexpr. Halves x until the
+  // series converges fast, then squares the result back up.
+  static constexpr float exp_approx(float x){
+    int halvings = 0;
+    while (x > 0.5f || x < -0.5f){
+      x /= 2;
+      halvings++;
+    }
+    float sum = 1;
+    float term = 1;
+    for (int n = 1; n < 10; n++){
+      term *= x/n;
+      sum += term;
+    }
+    for (int i = 0; i < halvings; i++){
+      sum *= sum;
+    }
+    return sum;
+  }
+};
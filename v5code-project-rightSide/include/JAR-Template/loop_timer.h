@@ -0,0 +1,30 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Fixed-rate scheduler for control loops. Instead of sleeping a fixed
+ * amount after each iteration, wait() sleeps until the next absolute
+ * deadline, so compute time and device reads don't stretch the period.
+ * It also records how late each tick woke up (jitter).
+ */
+
+class LoopTimer
+{
+public:
+  float period = 10;
+  uint64_t start_time_us = 0;
+  uint64_t next_deadline_us = 0;
+  uint64_t tick_time_us = 0;
+  int32_t last_jitter_us = 0;
+  int32_t max_jitter_us = 0;
+  int tick_count = 0;
+  int missed_ticks = 0;
+
+  LoopTimer(float period);
+
+  void start();
+
+  void wait();
+
+  float elapsed_ms();
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "vex.h"
+#include <functional>
+
+class Drive;
+
+/**
+ * Progress of the chassis' current motion. Every motion loop in
+ * drive.cpp keeps this up to date, and async motions also mark it
+ * running until their background task finishes. started is false
+ * from the async call until the loop has measured its start error.
+ * peak_voltage and profile_step feed the auton profiler.
+ */
+
+struct MotionState
+{
+  int id = 0;
+  bool running = false;
+  bool started = false;
+  bool cancelled = false;
+  float start_error = 0;
+  float error = 0;
+  float peak_voltage = 0;
+  int profile_step = -1;
+};
+
+/**
+ * Handle to a motion started with one of the Drive *_async functions.
+ * Units are whatever the motion works in: inches for drives, degrees
+ * for turns and swings.
+ */
+
+class Motion
+{
+public:
+  Drive *drive = nullptr;
+  int id = 0;
+
+  Motion(Drive *drive, int id);
+
+  bool is_done();
+
+  float remaining_error();
+
+  float traveled();
+
+  float fraction_traveled();
+
+  void wait();
+
+  void wait_until(float traveled);
+
+  void wait_until_fraction(float fraction);
+
+  void cancel();
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Change-detecting command layer over a motor or motor group. Each
+ * spin() or stop() only goes out over the smart port if it differs from
+ * the last command sent, by more than voltage_tolerance for voltages,
+ * or if keep_alive_ms has passed since then. A fast driver loop that
+ * holds the same command costs almost no port traffic. Each command
+ * that didn't go out counts as one saved transaction per motor.
+ */
+
+class MotorCommand
+{
+public:
+  enum command_type {COMMAND_NONE, COMMAND_VOLTAGE, COMMAND_STOP, COMMAND_BRAKE};
+
+  motor *single = nullptr;
+  motor_group *group = nullptr;
+  int motor_count = 1;
+  float voltage_tolerance = 0.05;
+  uint32_t keep_alive_ms = 100;
+  command_type last_command = COMMAND_NONE;
+  float last_voltage = 0;
+  brakeType last_brake = brakeType::coast;
+  uint32_t last_sent_ms = 0;
+  uint32_t sent = 0;
+  uint32_t saved = 0;
+
+  static uint32_t total_sent;
+  static uint32_t total_saved;
+
+  MotorCommand(motor &single);
+
+  MotorCommand(motor_group &group);
+
+  void spin(float voltage);
+
+  void stop();
+
+  void stop(brakeType mode);
+
+  void invalidate();
+
+private:
+  bool needs_send(command_type command, float voltage, brakeType mode);
+};
@@ -1,3 +1,20 @@
+#include <atomic>
+
+enum odom_method {PILONS_ARC, ROTATED_ARC};
+
+/**
+ * One consistent odometry reading: position, orientation, and the
+ * time it was computed.
+ */
+
+struct OdomPose
+{
+  float X_position = 0;
+  float Y_position = 0;
+  float orientation_deg = 0;
+  uint64_t time_us = 0;
+};
+
 /**
  * General-use odometry class with X_position, Y_position, and
  * orientation_deg being the relevant outputs. This works for one
@@ -15,7 +32,18 @@ public:
   float X_position;
   float Y_position;
   float orientation_deg;
+  odom_method method = ROTATED_ARC;
+
+  // Published copies of the pose for other tasks. See publish_pose().
+  OdomPose published_poses[2];
+  std::atomic<uint32_t> pose_sequence{0};
+  void publish_pose();
+  OdomPose get_pose();
+
   void set_position(float X_position, float Y_position, float orientation_deg, float ForwardTracker_position, float SidewaysTracker_position);
   void update_position(float ForwardTracker_position, float SidewaysTracker_position, float orientation_deg);
+  void update_position_rotated(float ForwardTracker_position, float SidewaysTracker_position, float orientation_deg);
   void set_physical_distances(float ForwardTracker_center_distance, float SidewaysTracker_center_distance);
+  float get_ForwardTracker_center_distance();
+  float get_SidewaysTracker_center_distance();
 };
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Waypoint path for follow_path(). Points are stored struct-of-arrays
+ * with the distance along the path to each one precomputed, so the
+ * follower's closest-point and lookahead searches are a forward scan
+ * over contiguous floats. Paths are fixed-size so they can be built
+ * as globals or on a task stack without allocating.
+ */
+
+class Path
+{
+public:
+  static const int max_waypoints = 64;
+  float X_position[max_waypoints];
+  float Y_position[max_waypoints];
+  float distance[max_waypoints];
+  int count = 0;
+  float length = 0;
+
+  Path();
+
+  Path(const float *X_positions, const float *Y_positions, int count);
+
+  bool add_point(float X_position, float Y_position);
+
+  int closest_segment(float X_position, float Y_position, int start_segment, int search_segments, float &progress);
+
+  int point_at(float path_distance, int start_segment, float &X_position, float &Y_position);
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Acceleration-limited motion profile for a move of a given length.
+ * Ramps up to max_velocity, cruises, and ramps back down to stop
+ * exactly on the target. If the move is too short to reach
+ * max_velocity, the peak is lowered and it never cruises. The ramps
+ * are either constant acceleration (trapezoidal) or a half-cosine
+ * S-curve that starts and ends with zero acceleration.
+ */
+
+class MotionProfile
+{
+public:
+  float distance = 0;
+  float peak_velocity = 0;
+  float ramp_time = 0;
+  float cruise_time = 0;
+  float duration = 0;
+  bool s_curve = false;
+
+  float position = 0;
+  float velocity = 0;
+  float acceleration = 0;
+
+  MotionProfile(float distance, float max_velocity, float max_acceleration, bool s_curve);
+
+  void sample(float time);
+};
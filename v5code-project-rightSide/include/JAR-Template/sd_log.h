@@ -0,0 +1,69 @@
+#pragma once
+#include "vex.h"
+
+/**
+ * Binary log file for the Brain's SD card. A file is a header naming
+ * each channel, then a stream of frames:
+ * 
+ *   header  "JLOG", version byte, varint channel count, then for each
+ *           channel its name (zero terminated) and a float32 scale
+ *   sample  SD_LOG_SAMPLE, zigzag varint microseconds since the last
+ *           frame, then for each channel the zigzag varint change in
+ *           round(value/scale) since the last sample
+ *   record  SD_LOG_RECORD, zigzag varint microseconds since the last
+ *           frame, varint motion id, type byte, state byte, float32
+ *           error, float32 output (a TelemetryRecord)
+ * 
+ * Varints are 7 bits per byte, low bits first. Floats are little
+ * endian. Zigzag maps signed values to unsigned ones (0, -1, 1, -2
+ * to 0, 1, 2, 3). Most channels change by a few counts per sample, so
+ * they take one byte each. Frames come from different tasks, so time
+ * can step back a little between them, and is stored exactly.
+ * build/sim/log_decode turns a file back into CSV.
+ */
+
+static const uint8_t SD_LOG_VERSION = 2;
+enum sd_log_frame : uint8_t {SD_LOG_SAMPLE = 1, SD_LOG_RECORD = 2};
+
+class SDLog
+{
+public:
+  static const int max_channels = 48;
+  static const int buffer_size = 4096;
+
+  char filename[32];
+  int channel_count = 0;
+  const char *channel_names[max_channels];
+  float channel_scales[max_channels];
+  int32_t channel_values[max_channels];
+  int32_t previous_values[max_channels];
+  uint32_t previous_time_us = 0;
+  bool header_written = false;
+
+  uint8_t buffer[buffer_size];
+  int buffer_length = 0;
+  uint32_t bytes_written = 0;
+  uint32_t rows_written = 0;
+  int failed_writes = 0;
+
+  SDLog(const char *filename);
+
+  int add_channel(const char *name, float scale);
+
+  void set(int channel, float value);
+
+  void write_sample(uint32_t time_us);
+
+  void write_record(const TelemetryRecord &record);
+
+  void flush();
+
+private:
+  void make_room(int length);
+  void put_byte(uint8_t value);
+  void put_varint(uint32_t value);
+  void put_signed(uint32_t value);
+  void put_float(float value);
+  void put_time(uint32_t time_us);
+  void write_header();
+};
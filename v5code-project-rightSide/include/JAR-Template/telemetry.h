@@ -0,0 +1,102 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+enum telemetry_type : uint8_t {TELEMETRY_PID_TICK, TELEMETRY_AUX_PID_TICK, TELEMETRY_SETTLED, TELEMETRY_MARK,
+  TELEMETRY_PID_CONFIG, TELEMETRY_AUX_PID_CONFIG, TELEMETRY_ODOM_SET, TELEMETRY_ODOM_UPDATE, TELEMETRY_ODOM_HEADING, TELEMETRY_ODOM_POSE,
+  TELEMETRY_INTAKE_JAM};
+
+enum settle_state : uint8_t {SETTLE_RUNNING, SETTLE_IN_BAND, SETTLE_TIMEOUT, SETTLE_TIME, SETTLE_FLAGS, SETTLE_VELOCITY};
+
+/**
+ * One telemetry record. PID ticks come from the motion's main
+ * controller (TELEMETRY_PID_TICK) or a helper like the heading
+ * controller (TELEMETRY_AUX_PID_TICK). TELEMETRY_SETTLED is written
+ * once when a motion ends, with why in state, and the velocity in
+ * output if it ended on velocity. TELEMETRY_MARK is a
+ * checkpoint from an auton, with its value in error.
+ * TELEMETRY_INTAKE_JAM is a roller jam the intake backed off from,
+ * with the roller in state and its current and torque in error and
+ * output.
+ * 
+ * The rest let a log be replayed exactly (see sim/tools/log_replay.cpp).
+ * Values that don't fit in one record are split over several, with
+ * the part number in state, always written back to back:
+ * 
+ *   PID_CONFIG      before a PID's first tick. Parts are (kp, ki),
+ *                   (kd, starti), (settle_error, settle_time),
+ *                   (timeout, update_period), (derivative_filter,
+ *                   settle flags or 0) and (settle_velocity, 0).
+ *   ODOM_SET        Odom::set_position(). Parts are (X, Y), (heading,
+ *                   forward tracker), (sideways tracker, odom method)
+ *                   and the two tracker center distances.
+ *   ODOM_UPDATE     Odom::update_position() inputs: forward and
+ *                   sideways trackers, then ODOM_HEADING with the
+ *                   heading, then ODOM_POSE with the resulting X, Y.
+ */
+
+struct TelemetryRecord
+{
+  uint32_t time_us;
+  uint16_t motion_id;
+  uint8_t type;
+  uint8_t state;
+  float error;
+  float output;
+};
+
+/**
+ * Fixed-size, lock-free queue of binary records, so control loops can
+ * log every tick without blocking on serial output. Any task can
+ * write; writes never wait or allocate, and are dropped (and counted)
+ * when the queue is full. Exactly one task reads it: the low-priority
+ * task started by start(), which prints what verbose asks for, or
+ * whatever task a caller uses in its place, like the match log. The
+ * ring is the bounded queue from Dmitry Vyukov, with a sequence number
+ * per slot telling writers and the reader whose turn it is.
+ */
+
+class Telemetry
+{
+public:
+  static const uint32_t capacity = 1024;
+
+  struct Slot
+  {
+    std::atomic<uint32_t> sequence;
+    TelemetryRecord record;
+  };
+  Slot slots[capacity];
+  std::atomic<uint32_t> write_index{0};
+  uint32_t read_index = 0;
+  std::atomic<uint32_t> dropped{0};
+
+  // Stamped into every record. Drive sets it when a motion begins.
+  std::atomic<uint16_t> motion_id{0};
+
+  // Print settle events, marks and every PID tick as they're drained.
+  // Off by default, since printing every event floods the console.
+  bool verbose = false;
+  int drain_period = 20;
+  vex::task drain_task;
+
+  Telemetry();
+
+  bool log(telemetry_type type, uint8_t state, float error, float output, uint64_t time_us);
+
+  bool log(telemetry_type type, uint8_t state, float error, float output);
+
+  void mark(float value);
+
+  bool pop(TelemetryRecord &record);
+
+  int drain(void (*sink)(const TelemetryRecord &record));
+
+  void start();
+
+  static void print(const TelemetryRecord &record);
+
+  static int drain_task_entry(void *telemetry);
+};
+
+extern Telemetry telemetry;
@@ -11,8 +11,12 @@ void drive_test();
 void turn_test();
 void swing_test();
 void full_test();
+void async_test();
+void profiled_test();
+void characterization_test();
 void odom_test();
 void tank_odom_test();
+void path_test();
 void holonomic_odom_test();
 
 /*********** push back autons ***************/
@@ -20,4 +24,8 @@ void AWP_solo();
 void leftSide();
 void rightSide();
 void matchLoadtest();
-void FlagTest();
\ No newline at end of file
+void FlagTest();
+
+// Every auton the selector can pick, in the order it cycles through them.
+extern const AutonEntry auton_registry[];
+extern const int auton_count;
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include "JAR-Template/drive.h"
+
+//named roller modes, shared by the autons and driver control
+enum intakeMode {INTAKE_STOP, INTAKE_BUCKET, INTAKE_SCORE_LONG, INTAKE_SCORE_UPPER_CENTER,
+INTAKE_OUTTAKE_LOWER_CENTER, INTAKE_PUSH_TOP, INTAKE_MODE_COUNT};
+
+//roller voltages for a mode, out of 12 before battery compensation. positive is fwd
+struct IntakeModeVoltages
+{
+  const char *name;
+  float bottom;
+  float middle;
+  float top;
+};
+
+extern const IntakeModeVoltages intakeModes[INTAKE_MODE_COUNT];
+
+//the three rollers as one subsystem. set() changes mode right away and
+//never blocks, so autons can change modes in the middle of a drive.
+//runFor() runs a mode for a while and then stops, timed by the intake's
+//own task, which also keeps the motors commanded and watches for jams.
+//a roller that draws jamCurrent while turning slower than jamVelocity
+//for jamTime is jammed: every running roller backs off at unjamVoltage
+//for unjamTime, then the mode picks up again
+class Intake
+{
+public:
+  static const int rollerCount = 3;
+  intakeMode mode = INTAKE_STOP;
+  float voltage = 0;
+  bool timed = false;
+  uint32_t stopTime = 0;
+
+  float jamCurrent = 2.0;
+  float jamVelocity = 20;
+  int jamTime = 150;
+  int spinUpTime = 250;
+  float unjamVoltage = 6;
+  int unjamTime = 150;
+  bool unjamming = false;
+  int jams = 0;
+  //fraction of each roller's voltage to use, set by the motor health monitor
+  float derating[rollerCount] = {1, 1, 1};
+
+  Intake(motor &bottom, motor &middle, motor &top);
+
+  void start();
+  void set(intakeMode mode);
+  void set(intakeMode mode, float voltage);
+  void runFor(intakeMode mode, float voltage, uint32_t ms);
+  void stop();
+  void wait();
+
+private:
+  motor *rollers[rollerCount];
+  MotorCommand commands[rollerCount];
+  int stalledTime[rollerCount] = {};
+  uint32_t spinUpEnd = 0;
+  uint32_t unjamEnd = 0;
+  int profileStep = -1;
+  task intakeTask;
+
+  void change(intakeMode mode, float voltage);
+  void endTimed(uint8_t reason);
+  float rollerVoltage(int roller);
+  void checkJams();
+  void apply();
+  static int intakeTaskEntry(void *intake);
+};
+
+extern Intake intake;
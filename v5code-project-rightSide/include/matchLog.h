@@ -0,0 +1,11 @@
+#pragma once
+#include "JAR-Template/drive.h"
+
+
+class Drive;
+
+extern Drive chassis;
+extern competition Competition;
+
+void startMatchLog();
+void flushMatchLog();
@@ -0,0 +1,37 @@
+#pragma once
+#include "JAR-Template/drive.h"
+
+
+class Drive;
+
+extern Drive chassis;
+
+//latest reading of one motor, published by the motor health task
+struct MotorHealthState
+{
+  const char *name;
+  float temperature; //celsius
+  float current;     //amps
+  float efficiency;  //percent
+  float derating;    //fraction of its voltage it's allowed, 1 is full power
+};
+
+//one motor's entry in the history, packed into 4 bytes
+struct MotorHealthSample
+{
+  uint8_t temperature; //half degrees celsius
+  uint8_t current;     //tenths of an amp, up to 25.5
+  uint8_t efficiency;  //percent
+  uint8_t derating;    //percent
+};
+
+const int motorHealthCount = 9;
+//one row a second, enough for a whole match
+const int motorHealthHistoryLength = 128;
+
+extern MotorHealthState motorHealth[motorHealthCount];
+extern MotorHealthSample motorHealthHistory[motorHealthHistoryLength][motorHealthCount];
+extern int motorHealthRows;
+
+void startMotorHealth();
+float motorDerating(float temperature);
@@ -19,12 +19,29 @@
 #include "v5_vcs.h"
 
 #include "robot-config.h"
+#include "JAR-Template/loop_timer.h"
+#include "JAR-Template/battery.h"
+#include "JAR-Template/motor_command.h"
+#include "JAR-Template/telemetry.h"
+#include "JAR-Template/auton_profiler.h"
+#include "JAR-Template/auton_selector.h"
+#include "JAR-Template/sd_log.h"
 #include "JAR-Template/odom.h"
+#include "JAR-Template/motion.h"
+#include "JAR-Template/profile.h"
+#include "JAR-Template/feedforward.h"
+#include "JAR-Template/path.h"
+#include "JAR-Template/gain_schedule.h"
+#include "JAR-Template/joystick_curve.h"
 #include "JAR-Template/drive.h"
 #include "JAR-Template/util.h"
+#include "JAR-Template/fast_math.h"
 #include "JAR-Template/PID.h"
 #include "autons.h"
 #include "buttonCtrl.h"
+#include "matchLog.h"
+#include "intake.h"
+#include "motorHealth.h"
 
 #define waitUntil(condition)                                                   \
   do {                                                                         \
@@ -32,4 +49,4 @@
   } while (!(condition))
 
 #define repeat(iterations)                                                     \
-  for (int iterator = 0; iterator < iterations; iterator++)
\ No newline at end of file
+  for (int iterator = 0; iterator < iterations; iterator++)
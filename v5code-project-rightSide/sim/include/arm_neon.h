@@ -0,0 +1,57 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Host stand-in for the NEON intrinsics that fast_math.cpp uses, one
+ * lane at a time, so `make mathbench` can check the vector code paths
+ * against the scalar ones without an ARM toolchain. Only built when
+ * SIM_NEON is defined; it models results, not speed.
+ */
+
+struct float32x4_t { float v[4]; };
+struct int32x4_t { int32_t v[4]; };
+struct uint32x4_t { uint32_t v[4]; };
+
+#define NEON_LANES(type, expr) { type r; for(int i = 0; i < 4; i++){ r.v[i] = (expr); } return r; }
+
+inline float32x4_t vld1q_f32(const float *p){ float32x4_t r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void vst1q_f32(float *p, float32x4_t a){ memcpy(p, a.v, sizeof(a.v)); }
+inline float32x4_t vdupq_n_f32(float x) NEON_LANES(float32x4_t, x)
+inline int32x4_t vdupq_n_s32(int32_t x) NEON_LANES(int32x4_t, x)
+inline uint32x4_t vdupq_n_u32(uint32_t x) NEON_LANES(uint32x4_t, x)
+
+inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b) NEON_LANES(float32x4_t, a.v[i]+b.v[i])
+inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b) NEON_LANES(float32x4_t, a.v[i]-b.v[i])
+inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) NEON_LANES(float32x4_t, a.v[i]*b.v[i])
+inline float32x4_t vmulq_n_f32(float32x4_t a, float b) NEON_LANES(float32x4_t, a.v[i]*b)
+// vmla/vmls round the product before adding, like the ARMv7 instructions.
+inline float32x4_t vmlaq_f32(float32x4_t a, float32x4_t b, float32x4_t c) NEON_LANES(float32x4_t, a.v[i]+(float)(b.v[i]*c.v[i]))
+inline float32x4_t vmlsq_n_f32(float32x4_t a, float32x4_t b, float c) NEON_LANES(float32x4_t, a.v[i]-(float)(b.v[i]*c))
+inline int32x4_t vaddq_s32(int32x4_t a, int32x4_t b) NEON_LANES(int32x4_t, (int32_t)((uint32_t)a.v[i]+(uint32_t)b.v[i]))
+
+inline int32x4_t vcvtq_s32_f32(float32x4_t a) NEON_LANES(int32x4_t, (int32_t)a.v[i])
+inline float32x4_t vcvtq_f32_s32(int32x4_t a) NEON_LANES(float32x4_t, (float)a.v[i])
+
+inline uint32x4_t vcltq_f32(float32x4_t a, float32x4_t b) NEON_LANES(uint32x4_t, a.v[i] < b.v[i] ? 0xFFFFFFFFu : 0)
+inline uint32x4_t vcgtq_f32(float32x4_t a, float32x4_t b) NEON_LANES(uint32x4_t, a.v[i] > b.v[i] ? 0xFFFFFFFFu : 0)
+inline uint32x4_t vcgeq_f32(float32x4_t a, float32x4_t b) NEON_LANES(uint32x4_t, a.v[i] >= b.v[i] ? 0xFFFFFFFFu : 0)
+inline uint32x4_t vtstq_s32(int32x4_t a, int32x4_t b) NEON_LANES(uint32x4_t, (a.v[i] & b.v[i]) ? 0xFFFFFFFFu : 0)
+
+inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b) NEON_LANES(uint32x4_t, a.v[i] & b.v[i])
+inline uint32x4_t veorq_u32(uint32x4_t a, uint32x4_t b) NEON_LANES(uint32x4_t, a.v[i] ^ b.v[i])
+inline uint32x4_t vshlq_n_u32(uint32x4_t a, int n) NEON_LANES(uint32x4_t, a.v[i] << n)
+
+inline float32x4_t vreinterpretq_f32_u32(uint32x4_t a){ float32x4_t r; memcpy(r.v, a.v, sizeof(r.v)); return r; }
+inline uint32x4_t vreinterpretq_u32_f32(float32x4_t a){ uint32x4_t r; memcpy(r.v, a.v, sizeof(r.v)); return r; }
+inline uint32x4_t vreinterpretq_u32_s32(int32x4_t a){ uint32x4_t r; memcpy(r.v, a.v, sizeof(r.v)); return r; }
+
+inline float32x4_t vbslq_f32(uint32x4_t mask, float32x4_t a, float32x4_t b){
+  uint32x4_t ua = vreinterpretq_u32_f32(a);
+  uint32x4_t ub = vreinterpretq_u32_f32(b);
+  uint32x4_t r;
+  for(int i = 0; i < 4; i++){ r.v[i] = (mask.v[i] & ua.v[i]) | (~mask.v[i] & ub.v[i]); }
+  return vreinterpretq_f32_u32(r);
+}
+
+#undef NEON_LANES
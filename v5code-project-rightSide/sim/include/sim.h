@@ -0,0 +1,132 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       sim.h                                                     */
+/*    Description:  Simulated world behind the host stand-in device API.      */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#pragma once
+#include <stdint.h>
+#include "v5_vcs.h"
+
+namespace sim {
+
+/**
+ * Physical constants of the simulated robot. The defaults match the
+ * rightSide chassis: six 600rpm motors on 3.25" wheels through a 0.75
+ * external ratio, with the IMU on PORT8.
+ */
+
+struct robot_config {
+  int32_t left_ports[3] = {vex::PORT18, vex::PORT19, vex::PORT20};
+  int32_t right_ports[3] = {vex::PORT17, vex::PORT14, vex::PORT16};
+  int32_t imu_port = vex::PORT8;
+  double wheel_diameter_in = 3.25;
+  double wheel_ratio = 0.75;
+  double track_width_in = 11.5;
+  double mass_kg = 6.8;
+  double moment_of_inertia = 0.15;
+  double rolling_friction_n = 4.0;
+  double scrub_friction_nm = 1.2;
+  double traction_coefficient = 1.0;
+  double battery_capacity_pct = 100;
+  const char *sd_card_directory = nullptr;
+};
+
+/**
+ * Ground-truth pose of the simulated chassis. Heading is clockwise
+ * positive from +Y, matching the JAR-Template convention.
+ */
+
+struct pose {
+  double x_in;
+  double y_in;
+  double heading_deg;
+  double linear_in_per_s;
+  double angular_deg_per_s;
+};
+
+/**
+ * State of one simulated smart motor, stored in the user's frame so a
+ * reversed drive motor spinning forward pushes the robot forward.
+ */
+
+struct motor_state {
+  bool installed = false;
+  bool reversed = false;
+  double free_rpm = 200;
+  double position_deg = 0;
+  double velocity_rpm = 0;
+  enum { STOPPED, VOLTAGE, VELOCITY } mode = STOPPED;
+  double command = 0;
+  double default_velocity_pct = 50;
+  vex::brakeType stopping = vex::brakeType::coast;
+  vex::brakeType active_brake = vex::brakeType::coast;
+  double hold_position_deg = 0;
+  double applied_voltage = 0;
+  double current_a = 0;
+  double torque_nm = 0;
+  double temperature_c = 25;
+  double max_current_a = 2.5;
+  double load_inertia = 0.0004;
+  // Nonzero while something is wedged against the rollers: turning
+  // this way (+1 or -1) is blocked until the motor backs off.
+  int jam_direction = 0;
+};
+
+struct imu_state {
+  bool installed = false;
+  double rotation_offset_deg = 0;
+  double heading_offset_deg = 0;
+  uint64_t calibrated_at_us = 0;
+};
+
+/**
+ * Joystick and button state of a simulated controller. Axes are in
+ * the controller's -127..127 range.
+ */
+
+struct controller_state {
+  int32_t axis[4] = {0, 0, 0, 0};
+  bool button[12] = {};
+};
+
+void configure(const robot_config &config);
+const robot_config &config();
+
+// Resets the clock, the devices, the chassis and kills every task.
+void reset();
+
+// Advances the world by one physics step without running any task.
+void step();
+
+uint64_t now_us();
+const pose &true_pose();
+motor_state &motor(int32_t port);
+imu_state &imu(int32_t port);
+controller_state &controller(vex::controllerType type);
+double battery_voltage();
+double battery_current();
+double battery_capacity();
+
+// Wedges something against a motor in the direction it's turning.
+void jam(int32_t port);
+
+// Runs fn as a task until it returns or limit_ms of simulated time passes.
+// Background tasks it started are stopped before this returns.
+bool run(void (*fn)(void), uint32_t limit_ms);
+
+// Clears device state for reset(); installation and wiring are kept.
+void reset_devices();
+void reset_device_offsets();
+
+// Scheduler hooks used by the device layer.
+int32_t spawn(int (*callback)(void *), void *arg, int32_t priority);
+void sleep_current(uint64_t duration_us);
+void yield_current();
+void stop_task(int32_t id);
+void suspend_task(int32_t id, bool suspended);
+bool task_alive(int32_t id);
+int32_t current_task();
+
+} // namespace sim
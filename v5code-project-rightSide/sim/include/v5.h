@@ -0,0 +1,17 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5.h                                                      */
+/*    Description:  Host simulator stand-in for the V5 SDK C header.          */
+/*                                                                            */
+/*    Only the pieces the project pulls in through vex.h are provided. The    */
+/*    device API itself lives in v5_vcs.h.                                    */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
@@ -0,0 +1,454 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5_vcs.h                                                  */
+/*    Description:  Host simulator stand-in for the VEXcode C++ device API.   */
+/*                                                                            */
+/*    Every class here is a thin handle onto the simulated world in sim.h,    */
+/*    so two handles on the same port (chassis.Gyro and GaryInertial, or a    */
+/*    motor and the motor_group holding it) observe the same device. Time     */
+/*    is virtual: task::sleep() and wait() hand control to the cooperative    */
+/*    scheduler, which steps the physics until the next task is due.          */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+namespace vex {
+
+enum class directionType { fwd, rev, undefined };
+enum class voltageUnits { volt, mV };
+enum class velocityUnits { pct, rpm, dps };
+enum class percentUnits { pct };
+enum class rotationUnits { deg, rev, raw };
+enum class timeUnits { sec, msec };
+enum class brakeType { coast, brake, hold, undefined };
+enum class temperatureUnits { celsius, fahrenheit };
+enum class currentUnits { amp };
+enum class torqueUnits { Nm, InLb };
+enum class powerUnits { watt };
+enum class gearSetting { ratio36_1, ratio18_1, ratio6_1 };
+enum class controllerType { primary, partner };
+enum class axisType { xaxis, yaxis, zaxis };
+enum class turnType { left, right };
+
+const directionType fwd = directionType::fwd;
+const directionType forward = directionType::fwd;
+const directionType reverse = directionType::rev;
+const voltageUnits volt = voltageUnits::volt;
+const voltageUnits mV = voltageUnits::mV;
+const velocityUnits rpm = velocityUnits::rpm;
+const velocityUnits dps = velocityUnits::dps;
+const percentUnits percent = percentUnits::pct;
+const percentUnits pct = percentUnits::pct;
+const rotationUnits deg = rotationUnits::deg;
+const rotationUnits degrees = rotationUnits::deg;
+const rotationUnits rev = rotationUnits::rev;
+const rotationUnits turns = rotationUnits::rev;
+const timeUnits sec = timeUnits::sec;
+const timeUnits seconds = timeUnits::sec;
+const timeUnits msec = timeUnits::msec;
+const brakeType coast = brakeType::coast;
+const brakeType brake = brakeType::brake;
+const brakeType hold = brakeType::hold;
+const temperatureUnits celsius = temperatureUnits::celsius;
+const temperatureUnits fahrenheit = temperatureUnits::fahrenheit;
+const currentUnits amp = currentUnits::amp;
+const torqueUnits Nm = torqueUnits::Nm;
+const powerUnits watt = powerUnits::watt;
+const gearSetting ratio36_1 = gearSetting::ratio36_1;
+const gearSetting ratio18_1 = gearSetting::ratio18_1;
+const gearSetting ratio6_1 = gearSetting::ratio6_1;
+const controllerType primary = controllerType::primary;
+const controllerType partner = controllerType::partner;
+const axisType xaxis = axisType::xaxis;
+const axisType yaxis = axisType::yaxis;
+const axisType zaxis = axisType::zaxis;
+
+const int32_t PORT1 = 0;
+const int32_t PORT2 = 1;
+const int32_t PORT3 = 2;
+const int32_t PORT4 = 3;
+const int32_t PORT5 = 4;
+const int32_t PORT6 = 5;
+const int32_t PORT7 = 6;
+const int32_t PORT8 = 7;
+const int32_t PORT9 = 8;
+const int32_t PORT10 = 9;
+const int32_t PORT11 = 10;
+const int32_t PORT12 = 11;
+const int32_t PORT13 = 12;
+const int32_t PORT14 = 13;
+const int32_t PORT15 = 14;
+const int32_t PORT16 = 15;
+const int32_t PORT17 = 16;
+const int32_t PORT18 = 17;
+const int32_t PORT19 = 18;
+const int32_t PORT20 = 19;
+const int32_t PORT21 = 20;
+const int32_t PORT22 = 21;
+
+void wait(double time, timeUnits units);
+
+/**
+ * Cooperative task handle. Priorities are stored but the simulator
+ * schedules purely by wake-up time, oldest waiter first on ties.
+ */
+
+class task {
+private:
+  int32_t _id = -1;
+public:
+  static const int32_t taskPriorityLow = 1;
+  static const int32_t taskPriorityNormal = 7;
+  static const int32_t taskPriorityHigh = 15;
+
+  task();
+  task(int (*callback)(void));
+  task(int (*callback)(void), int32_t priority);
+  task(int (*callback)(void *), void *arg);
+  task(int (*callback)(void *), void *arg, int32_t priority);
+
+  void stop();
+  void suspend();
+  void resume();
+  int32_t priority();
+  void setPriority(int32_t priority);
+  int32_t index() const { return _id; }
+
+  static void sleep(uint32_t time);
+  static void yield();
+  static void stop(const task &t);
+  static void suspend(const task &t);
+  static void resume(const task &t);
+};
+
+class thread {
+private:
+  int32_t _id = -1;
+public:
+  thread();
+  thread(void (*callback)(void));
+  thread(int (*callback)(void));
+  thread(void (*callback)(void *), void *arg);
+
+  void join();
+  void interrupt();
+  void detach();
+
+  static void sleep_for(uint32_t time_ms);
+};
+
+namespace this_thread {
+  void sleep_for(uint32_t time_ms);
+  void sleep_until(uint64_t time_ms);
+  void yield();
+  int32_t get_id();
+}
+
+class mutex {
+private:
+  bool _locked = false;
+public:
+  void lock();
+  bool try_lock();
+  void unlock();
+};
+
+class device {
+protected:
+  int32_t _index;
+public:
+  device(int32_t index) : _index(index) {}
+  int32_t index() const { return _index; }
+  bool installed();
+};
+
+class motor : public device {
+public:
+  motor(int32_t index);
+  motor(int32_t index, bool reverse);
+  motor(int32_t index, gearSetting gears);
+  motor(int32_t index, gearSetting gears, bool reverse);
+
+  void setReversed(bool value);
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setPosition(double value, rotationUnits units);
+  void resetPosition();
+  void setMaxTorque(double value, percentUnits units);
+  void setMaxTorque(double value, currentUnits units);
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+  void stop();
+  void stop(brakeType mode);
+
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double current(percentUnits units);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double power(powerUnits units = powerUnits::watt);
+  double torque(torqueUnits units = torqueUnits::Nm);
+  double efficiency(percentUnits units = percentUnits::pct);
+  double temperature(temperatureUnits units = temperatureUnits::celsius);
+  double temperature(percentUnits units);
+  bool isSpinning();
+  gearSetting getMotorCartridge();
+};
+
+class motor_group {
+private:
+  std::vector<motor> _motors;
+  void add(motor &m) { _motors.push_back(m); }
+public:
+  motor_group() {}
+  template <typename... Args>
+  motor_group(motor &m1, Args &... m2) { add(m1); int expand[] = {0, (add(m2), 0)...}; (void)expand; }
+
+  int32_t count() { return (int32_t)_motors.size(); }
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setPosition(double value, rotationUnits units);
+  void resetPosition();
+  void setMaxTorque(double value, percentUnits units);
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+  void stop();
+  void stop(brakeType mode);
+
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double power(powerUnits units = powerUnits::watt);
+  double torque(torqueUnits units = torqueUnits::Nm);
+  double efficiency(percentUnits units = percentUnits::pct);
+  double temperature(temperatureUnits units = temperatureUnits::celsius);
+  bool isSpinning();
+};
+
+class inertial : public device {
+public:
+  inertial(int32_t index, turnType dir = turnType::right);
+
+  void calibrate();
+  void startCalibration();
+  bool isCalibrating();
+  void resetHeading();
+  void resetRotation();
+  void setHeading(double value, rotationUnits units);
+  void setRotation(double value, rotationUnits units);
+  double heading(rotationUnits units = rotationUnits::deg);
+  double rotation(rotationUnits units = rotationUnits::deg);
+  double gyroRate(axisType axis, velocityUnits units);
+  double acceleration(axisType axis);
+};
+
+class rotation : public device {
+private:
+  bool _reversed;
+public:
+  rotation(int32_t index, bool reverse = false);
+
+  void setReversed(bool value);
+  void setPosition(double value, rotationUnits units);
+  void resetPosition();
+  double position(rotationUnits units);
+  double angle(rotationUnits units = rotationUnits::deg);
+  double velocity(velocityUnits units);
+};
+
+class triport {
+public:
+  class port {
+  private:
+    int32_t _smart;
+    int32_t _id;
+  public:
+    port(int32_t smart, int32_t id) : _smart(smart), _id(id) {}
+    int32_t smart() const { return _smart; }
+    int32_t id() const { return _id; }
+  };
+
+  port Port[8];
+  port &A;
+  port &B;
+  port &C;
+  port &D;
+  port &E;
+  port &F;
+  port &G;
+  port &H;
+
+  triport(int32_t index);
+  triport(const triport &other);
+  triport &operator=(const triport &other);
+};
+
+class encoder {
+private:
+  triport::port _port;
+public:
+  encoder(triport::port &port);
+
+  void setPosition(double value, rotationUnits units);
+  void resetRotation();
+  double position(rotationUnits units);
+  double rotation(rotationUnits units);
+  double velocity(velocityUnits units);
+};
+
+class digital_out {
+private:
+  triport::port _port;
+public:
+  digital_out(triport::port &port);
+
+  void set(bool value);
+  int32_t value();
+};
+
+class brain {
+public:
+  class lcd {
+  public:
+    void print(const char *format, ...);
+    void print(int value);
+    void print(double value);
+    void printAt(int32_t x, int32_t y, const char *format, ...);
+    void setCursor(int32_t row, int32_t col);
+    void newLine();
+    void clearScreen();
+    void clearLine();
+    void clearLine(int32_t number);
+    bool pressing();
+    int32_t xPosition();
+    int32_t yPosition();
+    void pressed(void (*callback)(void));
+    void released(void (*callback)(void));
+    bool render();
+  };
+
+  class battery {
+  public:
+    uint32_t capacity(percentUnits units = percentUnits::pct);
+    double voltage(voltageUnits units = voltageUnits::volt);
+    double current(currentUnits units = currentUnits::amp);
+    double temperature(percentUnits units = percentUnits::pct);
+  };
+
+  class timer {
+  public:
+    uint32_t time();
+    double time(timeUnits units);
+    double value();
+    void clear();
+    static uint32_t system();
+    static uint64_t systemHighResolution();
+  };
+
+  // Files go to the host directory given by sim::robot_config; with
+  // none set, the card reads as not inserted.
+  class sdcard {
+  public:
+    bool isInserted();
+    int32_t savefile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t appendfile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t loadfile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t size(const char *name);
+    bool exists(const char *name);
+  };
+
+  lcd Screen;
+  battery Battery;
+  timer Timer;
+  sdcard SDcard;
+  triport ThreeWirePort = triport(PORT22);
+};
+
+class timer {
+public:
+  uint32_t time();
+  double time(timeUnits units);
+  double value();
+  void clear();
+  static uint32_t system();
+  static uint64_t systemHighResolution();
+private:
+  uint64_t _start_us = systemHighResolution();
+};
+
+class controller {
+private:
+  controllerType _type;
+public:
+  class button {
+  private:
+    controllerType _type;
+    int32_t _id;
+  public:
+    button(controllerType type, int32_t id) : _type(type), _id(id) {}
+    bool pressing();
+    void pressed(void (*callback)(void));
+    void released(void (*callback)(void));
+  };
+
+  class axis {
+  private:
+    controllerType _type;
+    int32_t _id;
+  public:
+    axis(controllerType type, int32_t id) : _type(type), _id(id) {}
+    int32_t value();
+    int32_t position(percentUnits units = percentUnits::pct);
+  };
+
+  class lcd {
+  public:
+    void print(const char *format, ...);
+    void setCursor(int32_t row, int32_t col);
+    void clearScreen();
+    void clearLine(int32_t number);
+  };
+
+  controller(controllerType type = controllerType::primary);
+
+  button ButtonL1, ButtonL2, ButtonR1, ButtonR2;
+  button ButtonUp, ButtonDown, ButtonLeft, ButtonRight;
+  button ButtonX, ButtonB, ButtonY, ButtonA;
+  axis Axis1, Axis2, Axis3, Axis4;
+  lcd Screen;
+
+  void rumble(const char *pattern);
+};
+
+class competition {
+public:
+  void autonomous(void (*callback)(void));
+  void drivercontrol(void (*callback)(void));
+  bool isEnabled();
+  bool isAutonomous();
+  bool isDriverControl();
+  bool isCompetitionSwitch();
+  bool isFieldControl();
+};
+
+class vision {
+public:
+  class signature {};
+  class code {};
+};
+
+} // namespace vex
@@ -0,0 +1,67 @@
+# host simulator build rules
+
+# compile and link tools for the machine running make
+HOST_CXX  ?= g++
+
+SIM_BUILD  = $(BUILD)/sim
+SIM_BIN    = $(SIM_BUILD)/autonsim
+
+# the robot code the simulator runs, plus the stand-in SDK and physics
+SIM_SRC    = $(wildcard src/JAR-Template/*.cpp) src/autons.cpp src/robot-config.cpp src/buttonCtrl.cpp src/matchLog.cpp src/intake.cpp src/motorHealth.cpp
+SIM_SRC   += $(wildcard sim/src/*.cpp)
+SIM_OBJ    = $(addprefix $(SIM_BUILD)/, $(addsuffix .o, $(basename $(SIM_SRC))) )
+SIM_H      = $(SRC_H) $(wildcard include/*/*.h) $(wildcard sim/include/*.h)
+
+# sim/include goes first so vex.h picks up the stand-in v5.h and v5_vcs.h
+SIM_FLAGS  = -std=gnu++17 -O2 -Wall -Werror=return-type -Isim/include $(addprefix -I, ${INC_F})
+
+# compile C++ files for the host
+$(SIM_BUILD)/%.o: %.cpp $(SIM_H) $(SRC_A)
+	$(Q)$(MKDIR)
+	$(ECHO) "HOSTCXX $<"
+	$(Q)$(HOST_CXX) $(SIM_FLAGS) -c -o $@ $<
+
+# create simulator executable
+$(SIM_BIN): $(SIM_OBJ)
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+# host tools that link against parts of the robot code and the stand-in
+# SDK, without the simulator's main() or chassis
+SIM_CORE_OBJ = $(addprefix $(SIM_BUILD)/, $(addsuffix .o, $(basename $(filter-out sim/src/sim_main.cpp sim/src/chassis.cpp, $(wildcard sim/src/*.cpp)))) )
+
+# host tools that run the whole robot in the simulator
+SIM_ROBOT_OBJ = $(filter-out $(SIM_BUILD)/sim/src/sim_main.o, $(SIM_OBJ))
+
+# odometry kernel accuracy and speed benchmark
+$(SIM_BUILD)/odom_bench: $(SIM_BUILD)/sim/tools/odom_bench.o $(SIM_BUILD)/src/JAR-Template/odom.o $(SIM_BUILD)/src/JAR-Template/fast_math.o $(SIM_BUILD)/src/JAR-Template/util.o $(SIM_CORE_OBJ)
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+# angle and trig library accuracy and speed benchmark, with the NEON
+# code paths built against the host stand-in for arm_neon.h
+$(SIM_BUILD)/fast_math_neon.o: src/JAR-Template/fast_math.cpp $(SIM_H) $(SRC_A)
+	$(Q)$(MKDIR)
+	$(ECHO) "HOSTCXX $< (SIM_NEON)"
+	$(Q)$(HOST_CXX) $(SIM_FLAGS) -DSIM_NEON -c -o $@ $<
+
+$(SIM_BUILD)/math_bench: $(SIM_BUILD)/sim/tools/math_bench.o $(SIM_BUILD)/fast_math_neon.o $(SIM_BUILD)/src/JAR-Template/util.o $(SIM_CORE_OBJ)
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+# SD card log decoder
+$(SIM_BUILD)/log_decode: $(SIM_BUILD)/sim/tools/log_decode.o
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+# replays a log through Odom and PID
+$(SIM_BUILD)/log_replay: $(SIM_BUILD)/sim/tools/log_replay.o $(SIM_BUILD)/src/JAR-Template/PID.o $(SIM_BUILD)/src/JAR-Template/odom.o $(SIM_BUILD)/src/JAR-Template/telemetry.o $(SIM_BUILD)/src/JAR-Template/fast_math.o $(SIM_BUILD)/src/JAR-Template/util.o $(SIM_CORE_OBJ)
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+# searches PID gains against the simulator
+$(SIM_BUILD)/pid_tuner: $(SIM_BUILD)/sim/tools/pid_tuner.o $(SIM_ROBOT_OBJ)
+	$(ECHO) "HOSTLINK $@"
+	$(Q)$(HOST_CXX) -o $@ $^
+
+.PHONY: sim odombench mathbench logdecode logreplay pidtuner
\ No newline at end of file
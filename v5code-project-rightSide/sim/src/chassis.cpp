@@ -0,0 +1,25 @@
+#include "vex.h"
+
+// The competition the match log watches. The stand-in is always
+// enabled and in autonomous.
+competition Competition;
+
+// The chassis the simulator and the host tools drive. Keep this the
+// same as main.cpp, so the sim runs what the robot runs.
+Drive chassis(
+ZERO_TRACKER_NO_ODOM,
+motor_group(fl,ml,bl),
+motor_group(fr,mr,br),
+PORT8,
+3.25,
+0.75,
+360,
+PORT1,     -PORT2,
+PORT3,     -PORT4,
+3,
+2.75,
+-2,
+1,
+-2.75,
+5.5
+);
\ No newline at end of file
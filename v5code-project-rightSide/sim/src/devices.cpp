@@ -0,0 +1,549 @@
+#include "sim.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/**
+ * Host implementation of the vex:: device classes.
+ * Handles are stateless apart from their port; reads and writes go
+ * straight to the simulated world, converting units on the way.
+ */
+
+namespace vex {
+
+namespace {
+
+uint64_t brain_timer_start_us = 0;
+bool triport_state[22][8];
+double encoder_offset_deg[22][8];
+double rotation_offset_deg[22];
+
+double from_deg(double value, rotationUnits units){
+  if(units == rotationUnits::rev){ return value/360.0; }
+  return value;
+}
+
+double to_deg(double value, rotationUnits units){
+  if(units == rotationUnits::rev){ return value*360.0; }
+  return value;
+}
+
+double from_rpm(double rpm, double free_rpm, velocityUnits units){
+  if(units == velocityUnits::pct){ return rpm/free_rpm*100.0; }
+  if(units == velocityUnits::dps){ return rpm*6.0; }
+  return rpm;
+}
+
+double to_pct(double value, double free_rpm, velocityUnits units){
+  if(units == velocityUnits::rpm){ return value/free_rpm*100.0; }
+  if(units == velocityUnits::dps){ return value/6.0/free_rpm*100.0; }
+  return value;
+}
+
+double signed_by(directionType dir, double value){
+  return (dir == directionType::rev) ? -value : value;
+}
+
+double gear_rpm(gearSetting gears){
+  if(gears == gearSetting::ratio6_1){ return 600; }
+  if(gears == gearSetting::ratio36_1){ return 100; }
+  return 200;
+}
+
+void install(int32_t index, gearSetting gears, bool reverse){
+  sim::motor_state &m = sim::motor(index);
+  m.installed = true;
+  m.free_rpm = gear_rpm(gears);
+  m.reversed = reverse;
+}
+
+} // namespace
+
+void wait(double time, timeUnits units){
+  if(units == timeUnits::sec){ time *= 1000.0; }
+  task::sleep((uint32_t)time);
+}
+
+/*---------------------------------------------------------------------------*/
+/*                                   Tasks                                   */
+/*---------------------------------------------------------------------------*/
+
+namespace {
+
+int run_plain(void *callback){
+  return ((int (*)(void))callback)();
+}
+
+int run_void(void *callback){
+  ((void (*)(void))callback)();
+  return 0;
+}
+
+struct void_arg_call {
+  void (*callback)(void *);
+  void *arg;
+};
+
+int run_void_arg(void *call){
+  void_arg_call c = *(void_arg_call *)call;
+  delete (void_arg_call *)call;
+  c.callback(c.arg);
+  return 0;
+}
+
+} // namespace
+
+task::task() {}
+
+task::task(int (*callback)(void)) :
+  _id(sim::spawn(run_plain, (void *)callback, taskPriorityNormal)) {}
+
+task::task(int (*callback)(void), int32_t priority) :
+  _id(sim::spawn(run_plain, (void *)callback, priority)) {}
+
+task::task(int (*callback)(void *), void *arg) :
+  _id(sim::spawn(callback, arg, taskPriorityNormal)) {}
+
+task::task(int (*callback)(void *), void *arg, int32_t priority) :
+  _id(sim::spawn(callback, arg, priority)) {}
+
+void task::stop(){ sim::stop_task(_id); }
+void task::suspend(){ sim::suspend_task(_id, true); }
+void task::resume(){ sim::suspend_task(_id, false); }
+int32_t task::priority(){ return taskPriorityNormal; }
+void task::setPriority(int32_t priority){ (void)priority; }
+void task::sleep(uint32_t time){ sim::sleep_current((uint64_t)time*1000); }
+void task::yield(){ sim::yield_current(); }
+void task::stop(const task &t){ sim::stop_task(t._id); }
+void task::suspend(const task &t){ sim::suspend_task(t._id, true); }
+void task::resume(const task &t){ sim::suspend_task(t._id, false); }
+
+thread::thread() {}
+thread::thread(void (*callback)(void)) :
+  _id(sim::spawn(run_void, (void *)callback, task::taskPriorityNormal)) {}
+thread::thread(int (*callback)(void)) :
+  _id(sim::spawn(run_plain, (void *)callback, task::taskPriorityNormal)) {}
+thread::thread(void (*callback)(void *), void *arg) :
+  _id(sim::spawn(run_void_arg, new void_arg_call{callback, arg}, task::taskPriorityNormal)) {}
+
+void thread::join(){
+  while(sim::task_alive(_id)){ sim::sleep_current(1000); }
+}
+void thread::interrupt(){ sim::stop_task(_id); }
+void thread::detach(){}
+void thread::sleep_for(uint32_t time_ms){ task::sleep(time_ms); }
+
+namespace this_thread {
+  void sleep_for(uint32_t time_ms){ task::sleep(time_ms); }
+  void sleep_until(uint64_t time_ms){
+    uint64_t now_ms = sim::now_us()/1000;
+    if(time_ms > now_ms){ task::sleep((uint32_t)(time_ms-now_ms)); }
+  }
+  void yield(){ task::yield(); }
+  int32_t get_id(){ return sim::current_task(); }
+}
+
+void mutex::lock(){
+  while(_locked){ sim::yield_current(); }
+  _locked = true;
+}
+
+bool mutex::try_lock(){
+  if(_locked){ return false; }
+  _locked = true;
+  return true;
+}
+
+void mutex::unlock(){ _locked = false; }
+
+/*---------------------------------------------------------------------------*/
+/*                                  Motors                                   */
+/*---------------------------------------------------------------------------*/
+
+bool device::installed(){
+  return sim::motor(_index).installed || sim::imu(_index).installed;
+}
+
+motor::motor(int32_t index) : device(index) { install(index, gearSetting::ratio18_1, false); }
+motor::motor(int32_t index, bool reverse) : device(index) { install(index, gearSetting::ratio18_1, reverse); }
+motor::motor(int32_t index, gearSetting gears) : device(index) { install(index, gears, false); }
+motor::motor(int32_t index, gearSetting gears, bool reverse) : device(index) { install(index, gears, reverse); }
+
+void motor::setReversed(bool value){ sim::motor(_index).reversed = value; }
+
+void motor::setVelocity(double velocity, velocityUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  m.default_velocity_pct = to_pct(velocity, m.free_rpm, units);
+}
+
+void motor::setVelocity(double velocity, percentUnits units){ setVelocity(velocity, velocityUnits::pct); }
+void motor::setStopping(brakeType mode){ sim::motor(_index).stopping = mode; }
+void motor::setPosition(double value, rotationUnits units){ sim::motor(_index).position_deg = to_deg(value, units); }
+void motor::resetPosition(){ setPosition(0, rotationUnits::deg); }
+
+void motor::setMaxTorque(double value, percentUnits units){
+  sim::motor(_index).max_current_a = 2.5*fmax(0, fmin(100, value))/100.0;
+}
+
+void motor::setMaxTorque(double value, currentUnits units){
+  sim::motor(_index).max_current_a = fmax(0, fmin(2.5, value));
+}
+
+void motor::spin(directionType dir){
+  spin(dir, sim::motor(_index).default_velocity_pct, velocityUnits::pct);
+}
+
+void motor::spin(directionType dir, double velocity, velocityUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  m.mode = sim::motor_state::VELOCITY;
+  m.command = signed_by(dir, to_pct(velocity, m.free_rpm, units));
+}
+
+void motor::spin(directionType dir, double velocity, percentUnits units){ spin(dir, velocity, velocityUnits::pct); }
+
+void motor::spin(directionType dir, double voltage, voltageUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  if(units == voltageUnits::mV){ voltage /= 1000.0; }
+  m.mode = sim::motor_state::VOLTAGE;
+  m.command = signed_by(dir, voltage);
+}
+
+void motor::stop(){ stop(sim::motor(_index).stopping); }
+
+void motor::stop(brakeType mode){
+  sim::motor_state &m = sim::motor(_index);
+  if(m.mode != sim::motor_state::STOPPED || m.active_brake != mode){
+    m.hold_position_deg = m.position_deg;
+  }
+  m.mode = sim::motor_state::STOPPED;
+  m.active_brake = mode;
+  m.command = 0;
+}
+
+double motor::position(rotationUnits units){ return from_deg(sim::motor(_index).position_deg, units); }
+
+double motor::velocity(velocityUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  return from_rpm(m.velocity_rpm, m.free_rpm, units);
+}
+
+double motor::velocity(percentUnits units){ return velocity(velocityUnits::pct); }
+double motor::current(currentUnits units){ return fabs(sim::motor(_index).current_a); }
+double motor::current(percentUnits units){ return fabs(sim::motor(_index).current_a)/2.5*100.0; }
+double motor::voltage(voltageUnits units){
+  double volts = sim::motor(_index).applied_voltage;
+  return (units == voltageUnits::mV) ? volts*1000.0 : volts;
+}
+
+double motor::power(powerUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  return fabs(m.torque_nm*m.velocity_rpm*2*M_PI/60.0);
+}
+
+double motor::torque(torqueUnits units){
+  double nm = fabs(sim::motor(_index).torque_nm);
+  return (units == torqueUnits::InLb) ? nm*8.8507 : nm;
+}
+
+double motor::efficiency(percentUnits units){
+  sim::motor_state &m = sim::motor(_index);
+  double input = fabs(m.applied_voltage*m.current_a);
+  if(input < 1e-6){ return 0; }
+  return fmin(100, power()/input*100.0);
+}
+
+double motor::temperature(temperatureUnits units){
+  double c = sim::motor(_index).temperature_c;
+  return (units == temperatureUnits::fahrenheit) ? c*9.0/5.0+32 : c;
+}
+
+double motor::temperature(percentUnits units){
+  return fmax(0, fmin(100, (sim::motor(_index).temperature_c-20.0)/50.0*100.0));
+}
+
+bool motor::isSpinning(){ return fabs(sim::motor(_index).velocity_rpm) > 1; }
+
+gearSetting motor::getMotorCartridge(){
+  double rpm = sim::motor(_index).free_rpm;
+  if(rpm == 600){ return gearSetting::ratio6_1; }
+  if(rpm == 100){ return gearSetting::ratio36_1; }
+  return gearSetting::ratio18_1;
+}
+
+void motor_group::setVelocity(double velocity, velocityUnits units){ for(motor &m : _motors){ m.setVelocity(velocity, units); } }
+void motor_group::setVelocity(double velocity, percentUnits units){ for(motor &m : _motors){ m.setVelocity(velocity, units); } }
+void motor_group::setStopping(brakeType mode){ for(motor &m : _motors){ m.setStopping(mode); } }
+void motor_group::setPosition(double value, rotationUnits units){ for(motor &m : _motors){ m.setPosition(value, units); } }
+void motor_group::resetPosition(){ for(motor &m : _motors){ m.resetPosition(); } }
+void motor_group::setMaxTorque(double value, percentUnits units){ for(motor &m : _motors){ m.setMaxTorque(value, units); } }
+void motor_group::spin(directionType dir){ for(motor &m : _motors){ m.spin(dir); } }
+void motor_group::spin(directionType dir, double velocity, velocityUnits units){ for(motor &m : _motors){ m.spin(dir, velocity, units); } }
+void motor_group::spin(directionType dir, double velocity, percentUnits units){ for(motor &m : _motors){ m.spin(dir, velocity, units); } }
+void motor_group::spin(directionType dir, double voltage, voltageUnits units){ for(motor &m : _motors){ m.spin(dir, voltage, units); } }
+void motor_group::stop(){ for(motor &m : _motors){ m.stop(); } }
+void motor_group::stop(brakeType mode){ for(motor &m : _motors){ m.stop(mode); } }
+
+double motor_group::position(rotationUnits units){
+  return _motors.empty() ? 0 : _motors[0].position(units);
+}
+
+double motor_group::velocity(velocityUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.velocity(units); }
+  return _motors.empty() ? 0 : total/_motors.size();
+}
+
+double motor_group::velocity(percentUnits units){ return velocity(velocityUnits::pct); }
+
+double motor_group::current(currentUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.current(units); }
+  return total;
+}
+
+double motor_group::voltage(voltageUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.voltage(units); }
+  return _motors.empty() ? 0 : total/_motors.size();
+}
+
+double motor_group::power(powerUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.power(units); }
+  return total;
+}
+
+double motor_group::torque(torqueUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.torque(units); }
+  return total;
+}
+
+double motor_group::efficiency(percentUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.efficiency(units); }
+  return _motors.empty() ? 0 : total/_motors.size();
+}
+
+double motor_group::temperature(temperatureUnits units){
+  double total = 0;
+  for(motor &m : _motors){ total += m.temperature(units); }
+  return _motors.empty() ? 0 : total/_motors.size();
+}
+
+bool motor_group::isSpinning(){
+  for(motor &m : _motors){ if(m.isSpinning()){ return true; } }
+  return false;
+}
+
+/*---------------------------------------------------------------------------*/
+/*                                  Sensors                                  */
+/*---------------------------------------------------------------------------*/
+
+inertial::inertial(int32_t index, turnType dir) : device(index) {
+  sim::imu(index).installed = true;
+}
+
+void inertial::calibrate(){ startCalibration(); }
+void inertial::startCalibration(){ sim::imu(_index).calibrated_at_us = sim::now_us() + 2000000; }
+bool inertial::isCalibrating(){ return sim::now_us() < sim::imu(_index).calibrated_at_us; }
+
+void inertial::setRotation(double value, rotationUnits units){
+  sim::imu(_index).rotation_offset_deg = to_deg(value, units) - sim::true_pose().heading_deg;
+}
+
+void inertial::setHeading(double value, rotationUnits units){
+  sim::imu(_index).heading_offset_deg = to_deg(value, units) - sim::true_pose().heading_deg;
+}
+
+void inertial::resetRotation(){ setRotation(0, rotationUnits::deg); }
+void inertial::resetHeading(){ setHeading(0, rotationUnits::deg); }
+
+double inertial::rotation(rotationUnits units){
+  return from_deg(sim::true_pose().heading_deg + sim::imu(_index).rotation_offset_deg, units);
+}
+
+double inertial::heading(rotationUnits units){
+  double h = fmod(sim::true_pose().heading_deg + sim::imu(_index).heading_offset_deg, 360.0);
+  if(h < 0){ h += 360.0; }
+  return from_deg(h, units);
+}
+
+double inertial::gyroRate(axisType axis, velocityUnits units){
+  if(axis != axisType::zaxis){ return 0; }
+  double dps = sim::true_pose().angular_deg_per_s;
+  return (units == velocityUnits::rpm) ? dps/6.0 : dps;
+}
+
+double inertial::acceleration(axisType axis){ return 0; }
+
+rotation::rotation(int32_t index, bool reverse) : device(index), _reversed(reverse) {}
+void rotation::setReversed(bool value){ _reversed = value; }
+void rotation::setPosition(double value, rotationUnits units){ rotation_offset_deg[_index] = to_deg(value, units); }
+void rotation::resetPosition(){ setPosition(0, rotationUnits::deg); }
+double rotation::position(rotationUnits units){ return from_deg(rotation_offset_deg[_index], units); }
+double rotation::angle(rotationUnits units){ return from_deg(fmod(fabs(rotation_offset_deg[_index]), 360.0), units); }
+double rotation::velocity(velocityUnits units){ return 0; }
+
+triport::triport(int32_t index) :
+  Port{port(index, 0), port(index, 1), port(index, 2), port(index, 3), port(index, 4), port(index, 5), port(index, 6), port(index, 7)},
+  A(Port[0]), B(Port[1]), C(Port[2]), D(Port[3]), E(Port[4]), F(Port[5]), G(Port[6]), H(Port[7]) {}
+
+triport::triport(const triport &other) : triport(other.Port[0].smart()) {}
+
+triport &triport::operator=(const triport &other){
+  for(int i = 0; i < 8; i++){ Port[i] = other.Port[i]; }
+  return *this;
+}
+
+encoder::encoder(triport::port &port) : _port(port) {}
+void encoder::setPosition(double value, rotationUnits units){ encoder_offset_deg[_port.smart()][_port.id()] = to_deg(value, units); }
+void encoder::resetRotation(){ setPosition(0, rotationUnits::deg); }
+double encoder::position(rotationUnits units){ return from_deg(encoder_offset_deg[_port.smart()][_port.id()], units); }
+double encoder::rotation(rotationUnits units){ return position(units); }
+double encoder::velocity(velocityUnits units){ return 0; }
+
+digital_out::digital_out(triport::port &port) : _port(port) {}
+void digital_out::set(bool value){ triport_state[_port.smart()][_port.id()] = value; }
+int32_t digital_out::value(){ return triport_state[_port.smart()][_port.id()]; }
+
+/*---------------------------------------------------------------------------*/
+/*                            Brain and controller                           */
+/*---------------------------------------------------------------------------*/
+
+void brain::lcd::print(const char *format, ...) {}
+void brain::lcd::print(int value) {}
+void brain::lcd::print(double value) {}
+void brain::lcd::printAt(int32_t x, int32_t y, const char *format, ...) {}
+void brain::lcd::setCursor(int32_t row, int32_t col) {}
+void brain::lcd::newLine() {}
+void brain::lcd::clearScreen() {}
+void brain::lcd::clearLine() {}
+void brain::lcd::clearLine(int32_t number) {}
+bool brain::lcd::pressing(){ return false; }
+int32_t brain::lcd::xPosition(){ return 0; }
+int32_t brain::lcd::yPosition(){ return 0; }
+void brain::lcd::pressed(void (*callback)(void)) {}
+void brain::lcd::released(void (*callback)(void)) {}
+bool brain::lcd::render(){ return true; }
+
+uint32_t brain::battery::capacity(percentUnits units){ return (uint32_t)sim::battery_capacity(); }
+double brain::battery::voltage(voltageUnits units){
+  double volts = sim::battery_voltage();
+  return (units == voltageUnits::mV) ? volts*1000.0 : volts;
+}
+double brain::battery::current(currentUnits units){ return sim::battery_current(); }
+double brain::battery::temperature(percentUnits units){ return 25; }
+
+namespace {
+
+FILE *open_sd_file(const char *name, const char *mode){
+  const char *directory = sim::config().sd_card_directory;
+  if(directory == nullptr){ return nullptr; }
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  return fopen(path, mode);
+}
+
+int32_t write_sd_file(const char *name, uint8_t *buffer, int32_t len, const char *mode){
+  FILE *f = open_sd_file(name, mode);
+  if(f == nullptr){ return -1; }
+  int32_t written = (int32_t)fwrite(buffer, 1, len, f);
+  fclose(f);
+  return written;
+}
+
+} // namespace
+
+bool brain::sdcard::isInserted(){ return sim::config().sd_card_directory != nullptr; }
+int32_t brain::sdcard::savefile(const char *name, uint8_t *buffer, int32_t len){ return write_sd_file(name, buffer, len, "wb"); }
+int32_t brain::sdcard::appendfile(const char *name, uint8_t *buffer, int32_t len){ return write_sd_file(name, buffer, len, "ab"); }
+int32_t brain::sdcard::loadfile(const char *name, uint8_t *buffer, int32_t len){
+  FILE *f = open_sd_file(name, "rb");
+  if(f == nullptr){ return 0; }
+  int32_t read = (int32_t)fread(buffer, 1, len, f);
+  fclose(f);
+  return read;
+}
+int32_t brain::sdcard::size(const char *name){
+  FILE *f = open_sd_file(name, "rb");
+  if(f == nullptr){ return 0; }
+  fseek(f, 0, SEEK_END);
+  int32_t length = (int32_t)ftell(f);
+  fclose(f);
+  return length;
+}
+bool brain::sdcard::exists(const char *name){
+  FILE *f = open_sd_file(name, "rb");
+  if(f == nullptr){ return false; }
+  fclose(f);
+  return true;
+}
+
+uint32_t brain::timer::time(){ return (uint32_t)((sim::now_us()-brain_timer_start_us)/1000); }
+double brain::timer::time(timeUnits units){
+  double ms = (sim::now_us()-brain_timer_start_us)/1000.0;
+  return (units == timeUnits::sec) ? ms/1000.0 : ms;
+}
+double brain::timer::value(){ return time(timeUnits::sec); }
+void brain::timer::clear(){ brain_timer_start_us = sim::now_us(); }
+uint32_t brain::timer::system(){ return (uint32_t)(sim::now_us()/1000); }
+uint64_t brain::timer::systemHighResolution(){ return sim::now_us(); }
+
+uint32_t timer::time(){ return (uint32_t)((sim::now_us()-_start_us)/1000); }
+double timer::time(timeUnits units){
+  double ms = (sim::now_us()-_start_us)/1000.0;
+  return (units == timeUnits::sec) ? ms/1000.0 : ms;
+}
+double timer::value(){ return time(timeUnits::sec); }
+void timer::clear(){ _start_us = sim::now_us(); }
+uint32_t timer::system(){ return (uint32_t)(sim::now_us()/1000); }
+uint64_t timer::systemHighResolution(){ return sim::now_us(); }
+
+controller::controller(controllerType type) :
+  _type(type),
+  ButtonL1(type, 0), ButtonL2(type, 1), ButtonR1(type, 2), ButtonR2(type, 3),
+  ButtonUp(type, 4), ButtonDown(type, 5), ButtonLeft(type, 6), ButtonRight(type, 7),
+  ButtonX(type, 8), ButtonB(type, 9), ButtonY(type, 10), ButtonA(type, 11),
+  Axis1(type, 0), Axis2(type, 1), Axis3(type, 2), Axis4(type, 3) {}
+
+bool controller::button::pressing(){ return sim::controller(_type).button[_id]; }
+void controller::button::pressed(void (*callback)(void)) {}
+void controller::button::released(void (*callback)(void)) {}
+int32_t controller::axis::value(){ return sim::controller(_type).axis[_id]; }
+int32_t controller::axis::position(percentUnits units){ return value()*100/127; }
+void controller::lcd::print(const char *format, ...) {}
+void controller::lcd::setCursor(int32_t row, int32_t col) {}
+void controller::lcd::clearScreen() {}
+void controller::lcd::clearLine(int32_t number) {}
+void controller::rumble(const char *pattern) {}
+
+void competition::autonomous(void (*callback)(void)) {}
+void competition::drivercontrol(void (*callback)(void)) {}
+bool competition::isEnabled(){ return true; }
+bool competition::isAutonomous(){ return true; }
+bool competition::isDriverControl(){ return false; }
+bool competition::isCompetitionSwitch(){ return false; }
+bool competition::isFieldControl(){ return false; }
+
+} // namespace vex
+
+namespace sim {
+
+/**
+ * Clears the sensor offsets and pneumatics that live in the device
+ * layer, on top of the physical state in physics.cpp.
+ */
+
+void reset_device_offsets(){
+  for(int i = 0; i < 22; i++){
+    vex::rotation_offset_deg[i] = 0;
+    for(int j = 0; j < 8; j++){
+      vex::triport_state[i][j] = false;
+      vex::encoder_offset_deg[i][j] = 0;
+    }
+  }
+  vex::brain_timer_start_us = 0;
+}
+
+} // namespace sim
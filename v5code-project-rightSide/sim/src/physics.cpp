@@ -0,0 +1,280 @@
+#include "sim.h"
+#include <math.h>
+
+/**
+ * Physics for the host simulator.
+ * The chassis is a planar differential drive: each side's motors push
+ * through the external ratio onto the wheels, rolling friction and
+ * turning scrub resist, and the wheels can slip once a side asks for
+ * more than its share of traction. Motors follow a current-limited DC
+ * model, so they give constant torque up to half of free speed and
+ * then fall off linearly, like the V5 smart motor. Everything else
+ * (rollers) spins a small inertia of its own, which jam() can block
+ * until the motor reverses. The step is 1ms.
+ */
+
+namespace sim {
+
+namespace {
+
+const double dt = 0.001;
+const double gravity = 9.81;
+const double in_per_m = 39.3701;
+const double winding_resistance = 2.4;
+const double ambient_c = 25;
+const double thermal_capacity = 60;
+const double thermal_resistance = 4;
+const double hold_kp = 0.3;
+const double hold_kd = 0.02;
+const double velocity_kp = 0.01;
+const double battery_resistance = 0.08;
+const double battery_amp_hours = 1.1;
+
+robot_config world_config;
+pose world_pose;
+double linear_m_per_s = 0;
+double angular_rad_per_s = 0;
+double bus_voltage = 12.8;
+double bus_current = 0;
+double capacity_pct = 100;
+
+double sign(double value){
+  return (value > 0) - (value < 0);
+}
+
+double stall_torque(const motor_state &m){
+  return 2.1*100.0/m.free_rpm;
+}
+
+/**
+ * Works out the duty cycle the motor firmware would apply this step.
+ * Voltage commands are a fraction of 12V, so a sagging battery
+ * delivers less than was asked for.
+ *
+ * @param m Motor to evaluate.
+ * @return Duty cycle in [-1, 1].
+ */
+
+double duty(motor_state &m){
+  switch(m.mode){
+    case motor_state::VOLTAGE:
+      return fmax(-1, fmin(1, m.command/12.0));
+    case motor_state::VELOCITY: {
+      double target = m.command/100.0*m.free_rpm;
+      double d = target/m.free_rpm + velocity_kp*(target-m.velocity_rpm);
+      return fmax(-1, fmin(1, d));
+    }
+    case motor_state::STOPPED:
+    default:
+      if(m.active_brake == vex::brakeType::hold){
+        double volts = hold_kp*(m.hold_position_deg-m.position_deg) - hold_kd*m.velocity_rpm;
+        return fmax(-1, fmin(1, volts/12.0));
+      }
+      return 0;
+  }
+}
+
+/**
+ * Updates a motor's electrical state from its duty and shaft speed.
+ *
+ * @param m Motor to update.
+ * @return Output shaft torque in Nm.
+ */
+
+double electrical_update(motor_state &m){
+  if(!m.installed){ return 0; }
+  bool open = (m.mode == motor_state::STOPPED && m.active_brake == vex::brakeType::coast);
+  double d = duty(m);
+  m.applied_voltage = d*bus_voltage;
+  if(open){
+    m.current_a = 0;
+    m.applied_voltage = 0;
+  } else {
+    double back_emf = 12.0*m.velocity_rpm/m.free_rpm;
+    double current = (m.applied_voltage-back_emf)/winding_resistance;
+    m.current_a = fmax(-m.max_current_a, fmin(m.max_current_a, current));
+  }
+  m.torque_nm = stall_torque(m)/2.5*m.current_a;
+
+  double heat = m.current_a*m.current_a*winding_resistance;
+  m.temperature_c += (heat - (m.temperature_c-ambient_c)/thermal_resistance)/thermal_capacity*dt;
+  return m.torque_nm;
+}
+
+void integrate_position(motor_state &m){
+  m.position_deg += m.velocity_rpm*6.0*dt;
+}
+
+/**
+ * Applies Coulomb friction to a velocity, sticking at zero when the
+ * drive force can't overcome it.
+ *
+ * @param velocity Current velocity.
+ * @param force Net driving force or torque.
+ * @param friction Friction magnitude.
+ * @param inertia Mass or moment of inertia.
+ * @return The new velocity after one step.
+ */
+
+double friction_step(double velocity, double force, double friction, double inertia){
+  if(velocity == 0 && fabs(force) <= friction){
+    return 0;
+  }
+  double direction = (velocity != 0) ? sign(velocity) : sign(force);
+  double next = velocity + (force - friction*direction)/inertia*dt;
+  if(velocity != 0 && sign(next) != sign(velocity) && fabs(force) <= friction){
+    return 0;
+  }
+  return next;
+}
+
+bool is_drive_port(int32_t port){
+  for(int i = 0; i < 3; i++){
+    if(world_config.left_ports[i] == port || world_config.right_ports[i] == port){ return true; }
+  }
+  return false;
+}
+
+} // namespace
+
+void configure(const robot_config &config){
+  world_config = config;
+  capacity_pct = config.battery_capacity_pct;
+}
+
+const robot_config &config(){
+  return world_config;
+}
+
+motor_state &motor(int32_t port){
+  static motor_state motors[22];
+  return motors[(port >= 0 && port < 22) ? port : 21];
+}
+
+imu_state &imu(int32_t port){
+  static imu_state imus[22];
+  return imus[(port >= 0 && port < 22) ? port : 21];
+}
+
+controller_state &controller(vex::controllerType type){
+  static controller_state controllers[2];
+  return controllers[type == vex::controllerType::partner ? 1 : 0];
+}
+
+const pose &true_pose(){
+  return world_pose;
+}
+
+double battery_voltage(){
+  return bus_voltage;
+}
+
+double battery_current(){
+  return bus_current;
+}
+
+double battery_capacity(){
+  return capacity_pct;
+}
+
+void jam(int32_t port){
+  motor_state &m = motor(port);
+  double direction = m.velocity_rpm != 0 ? m.velocity_rpm : m.command;
+  m.jam_direction = (int)sign(direction);
+}
+
+void reset_devices(){
+  for(int32_t port = 0; port < 22; port++){
+    motor_state &m = motor(port);
+    m.position_deg = 0;
+    m.velocity_rpm = 0;
+    m.mode = motor_state::STOPPED;
+    m.command = 0;
+    m.stopping = vex::brakeType::coast;
+    m.active_brake = vex::brakeType::coast;
+    m.hold_position_deg = 0;
+    m.applied_voltage = 0;
+    m.current_a = 0;
+    m.torque_nm = 0;
+    m.temperature_c = ambient_c;
+    m.jam_direction = 0;
+    imu_state &g = imu(port);
+    g.rotation_offset_deg = 0;
+    g.heading_offset_deg = 0;
+    g.calibrated_at_us = 0;
+  }
+  controller(vex::controllerType::primary) = controller_state();
+  controller(vex::controllerType::partner) = controller_state();
+  world_pose = pose();
+  linear_m_per_s = 0;
+  angular_rad_per_s = 0;
+  capacity_pct = world_config.battery_capacity_pct;
+  bus_current = 0;
+  bus_voltage = 11.6 + 1.2*capacity_pct/100.0;
+  reset_device_offsets();
+}
+
+void step(){
+  const robot_config &c = world_config;
+  double wheel_radius_m = c.wheel_diameter_in/2.0/in_per_m;
+  double half_track_m = c.track_width_in/2.0/in_per_m;
+
+  double side_force[2] = {0, 0};
+  const int32_t *sides[2] = {c.left_ports, c.right_ports};
+  for(int s = 0; s < 2; s++){
+    for(int i = 0; i < 3; i++){
+      double torque = electrical_update(motor(sides[s][i]));
+      side_force[s] += torque/c.wheel_ratio/wheel_radius_m;
+    }
+    double traction = c.traction_coefficient*c.mass_kg*gravity/2.0;
+    side_force[s] = fmax(-traction, fmin(traction, side_force[s]));
+  }
+
+  linear_m_per_s = friction_step(linear_m_per_s, side_force[0]+side_force[1], c.rolling_friction_n, c.mass_kg);
+  angular_rad_per_s = friction_step(angular_rad_per_s, (side_force[0]-side_force[1])*half_track_m, c.scrub_friction_nm, c.moment_of_inertia);
+
+  double side_speed[2] = {linear_m_per_s + angular_rad_per_s*half_track_m, linear_m_per_s - angular_rad_per_s*half_track_m};
+  for(int s = 0; s < 2; s++){
+    double motor_rpm = side_speed[s]/wheel_radius_m/c.wheel_ratio*60.0/(2*M_PI);
+    for(int i = 0; i < 3; i++){
+      motor_state &m = motor(sides[s][i]);
+      m.velocity_rpm = motor_rpm;
+      integrate_position(m);
+    }
+  }
+
+  for(int32_t port = 0; port < 22; port++){
+    motor_state &m = motor(port);
+    if(!m.installed || is_drive_port(port)){ continue; }
+    double torque = electrical_update(m);
+    double omega = m.velocity_rpm*2*M_PI/60.0;
+    omega = friction_step(omega, torque - 0.0005*omega, 0.005, m.load_inertia);
+    if(m.jam_direction != 0){
+      if(omega*m.jam_direction < 0){
+        m.jam_direction = 0;
+      } else {
+        omega = 0;
+      }
+    }
+    m.velocity_rpm = omega*60.0/(2*M_PI);
+    integrate_position(m);
+  }
+
+  double heading_rad = world_pose.heading_deg*M_PI/180.0 + angular_rad_per_s*dt/2.0;
+  world_pose.x_in += linear_m_per_s*sin(heading_rad)*dt*in_per_m;
+  world_pose.y_in += linear_m_per_s*cos(heading_rad)*dt*in_per_m;
+  world_pose.heading_deg += angular_rad_per_s*dt*180.0/M_PI;
+  world_pose.linear_in_per_s = linear_m_per_s*in_per_m;
+  world_pose.angular_deg_per_s = angular_rad_per_s*180.0/M_PI;
+
+  double draw = 0;
+  for(int32_t port = 0; port < 22; port++){
+    motor_state &m = motor(port);
+    if(m.installed){ draw += fabs(m.current_a*duty(m)); }
+  }
+  bus_current = draw;
+  capacity_pct = fmax(0, capacity_pct - draw*dt/3600.0/battery_amp_hours*100.0);
+  bus_voltage = 11.6 + 1.2*capacity_pct/100.0 - battery_resistance*bus_current;
+}
+
+} // namespace sim
@@ -0,0 +1,188 @@
+#include "sim.h"
+#include <ucontext.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+ * Cooperative scheduler for the host simulator.
+ * Each vex::task runs on its own ucontext stack. A task only gives up
+ * the CPU by sleeping, yielding or stopping, so the world is frozen
+ * while it computes. When every task is asleep the scheduler steps the
+ * physics forward until the earliest one is due, which is what lets a
+ * 15 second auton finish in a few milliseconds of wall time.
+ */
+
+namespace sim {
+
+namespace {
+
+const size_t stack_size = 256*1024;
+const uint64_t step_us = 1000;
+
+struct coroutine {
+  ucontext_t context;
+  int32_t id;
+  char *stack;
+  int (*callback)(void *);
+  void *arg;
+  int32_t priority;
+  uint64_t wake_us;
+  uint64_t order;
+  bool done;
+  bool suspended;
+};
+
+std::vector<coroutine *> tasks;
+ucontext_t scheduler_context;
+int32_t running = -1;
+uint64_t clock_us = 0;
+uint64_t sequence = 0;
+
+void trampoline(int id){
+  coroutine *c = tasks[id];
+  c->callback(c->arg);
+  c->done = true;
+}
+
+/**
+ * Steps the physics until the clock reaches the given time.
+ *
+ * @param time_us Absolute simulated time in microseconds.
+ */
+
+void advance_to(uint64_t time_us){
+  while(clock_us + step_us <= time_us){
+    step();
+    clock_us += step_us;
+  }
+}
+
+/**
+ * Finds the task that should run next: the earliest wake-up time,
+ * with the task that has waited longest winning ties.
+ *
+ * @return The next task, or nullptr if nothing can run.
+ */
+
+coroutine *pick(){
+  coroutine *best = nullptr;
+  for(coroutine *c : tasks){
+    if(c->done || c->suspended){ continue; }
+    if(best == nullptr || c->wake_us < best->wake_us || (c->wake_us == best->wake_us && c->order < best->order)){
+      best = c;
+    }
+  }
+  return best;
+}
+
+void release_tasks(){
+  for(coroutine *c : tasks){
+    free(c->stack);
+    delete c;
+  }
+  tasks.clear();
+  running = -1;
+}
+
+int run_root(void *arg){
+  ((void (*)(void))arg)();
+  return 0;
+}
+
+} // namespace
+
+uint64_t now_us(){
+  return clock_us;
+}
+
+int32_t current_task(){
+  return running;
+}
+
+int32_t spawn(int (*callback)(void *), void *arg, int32_t priority){
+  coroutine *c = new coroutine();
+  c->stack = (char *)malloc(stack_size);
+  c->callback = callback;
+  c->arg = arg;
+  c->priority = priority;
+  c->wake_us = clock_us;
+  c->order = ++sequence;
+  c->done = false;
+  c->suspended = false;
+  int32_t id = (int32_t)tasks.size();
+  c->id = id;
+  tasks.push_back(c);
+
+  getcontext(&c->context);
+  c->context.uc_stack.ss_sp = c->stack;
+  c->context.uc_stack.ss_size = stack_size;
+  c->context.uc_link = &scheduler_context;
+  makecontext(&c->context, (void (*)(void))trampoline, 1, (int)id);
+  return id;
+}
+
+void sleep_current(uint64_t duration_us){
+  if(running < 0){
+    advance_to(clock_us + duration_us);
+    return;
+  }
+  coroutine *c = tasks[running];
+  c->wake_us = clock_us + duration_us;
+  c->order = ++sequence;
+  swapcontext(&c->context, &scheduler_context);
+}
+
+void yield_current(){
+  sleep_current(0);
+}
+
+void stop_task(int32_t id){
+  if(id < 0 || id >= (int32_t)tasks.size()){ return; }
+  tasks[id]->done = true;
+  if(id == running){
+    swapcontext(&tasks[id]->context, &scheduler_context);
+  }
+}
+
+void suspend_task(int32_t id, bool suspended){
+  if(id < 0 || id >= (int32_t)tasks.size()){ return; }
+  tasks[id]->suspended = suspended;
+  if(suspended && id == running){
+    yield_current();
+  }
+}
+
+bool task_alive(int32_t id){
+  return(id >= 0 && id < (int32_t)tasks.size() && !tasks[id]->done);
+}
+
+void reset(){
+  release_tasks();
+  clock_us = 0;
+  sequence = 0;
+  reset_devices();
+}
+
+bool run(void (*fn)(void), uint32_t limit_ms){
+  int32_t root = spawn(run_root, (void *)fn, vex::task::taskPriorityNormal);
+  uint64_t deadline = clock_us + (uint64_t)limit_ms*1000;
+  while(!tasks[root]->done){
+    coroutine *next = pick();
+    if(next == nullptr){ break; }
+    if(next->wake_us > deadline){
+      advance_to(deadline);
+      break;
+    }
+    advance_to(next->wake_us);
+    running = next->id;
+    swapcontext(&scheduler_context, &next->context);
+    running = -1;
+  }
+  bool finished = tasks[root]->done;
+  for(coroutine *c : tasks){
+    c->done = true;
+  }
+  return finished;
+}
+
+} // namespace sim
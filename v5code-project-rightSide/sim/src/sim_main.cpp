@@ -0,0 +1,166 @@
+#include "vex.h"
+#include "sim.h"
+#include <chrono>
+#include <string.h>
+
+/**
+ * Host simulator entry point.
+ * Builds the same chassis as main.cpp and runs autons against the
+ * physics model in virtual time, reporting how long each one takes on
+ * the simulated clock and where the robot ends up. Usage:
+ *
+ *   build/sim/autonsim                 runs AWP_solo, leftSide, rightSide
+ *   build/sim/autonsim turn_test ...   runs the named autons
+ *   build/sim/autonsim --list          lists the autons in auton_registry
+ *   build/sim/autonsim --battery 60 .. starts at 60% charge
+ *   build/sim/autonsim --sd DIR ...    logs each run to DIR/log_NNN.jlog
+ *   build/sim/autonsim --profile ...   prints each run's per-motion timings
+ *   build/sim/autonsim --jam 15@5000 . jams the roller on port 15 at 5s
+ *   build/sim/autonsim --check         checks async motion progress
+ */
+
+static const uint32_t auton_period_ms = 15000;
+static bool profile = false;
+static int32_t jam_port = -1;
+static uint32_t jam_ms = 0;
+
+static int jam_task(){
+  vex::task::sleep(jam_ms);
+  sim::jam(jam_port);
+  return 0;
+}
+
+static float check_fraction = 0;
+static float check_traveled = 0;
+static bool check_done = false;
+
+static void check_wait_until_fraction(){
+  Motion m = chassis.drive_distance_async(24);
+  m.wait_until_fraction(0.5);
+  check_fraction = m.fraction_traveled();
+  check_traveled = m.traveled();
+  check_done = m.is_done();
+  m.wait();
+}
+
+// wait_until_fraction(0.5) has to return part way through the drive,
+// not before the motion task has measured its start error.
+static int run_checks(){
+  sim::reset();
+  default_constants();
+  sim::run(check_wait_until_fraction, auton_period_ms);
+  bool ok = !check_done && check_fraction >= 0.5 && check_fraction < 0.75;
+  printf("wait_until_fraction(0.5) %-4s frac=%.2f traveled=%.2f in%s\n",
+    ok ? "ok" : "FAIL", check_fraction, check_traveled, check_done ? " (done)" : "");
+  return ok ? 0 : 1;
+}
+
+static const AutonEntry *current_auton = nullptr;
+static bool auton_finished = false;
+static double auton_end_ms = 0;
+
+static int auton_task(){
+  current_auton->run();
+  auton_end_ms = sim::now_us()/1000.0;
+  auton_finished = true;
+  return 0;
+}
+
+// Runs the auton the way the field does: it gets auton_period_ms and is
+// then stopped, and the match log is flushed from a task, as on the robot.
+static void auton_period(){
+  vex::task auton(auton_task);
+  while(!auton_finished && sim::now_us() < auton_period_ms*1000ull){
+    vex::task::sleep(10);
+  }
+  auton.stop();
+  if(!auton_finished){ auton_end_ms = auton_period_ms; }
+  flushMatchLog();
+}
+
+static const AutonEntry *find_auton(const char *name){
+  for(int i = 0; i < auton_count; i++){
+    if(strcmp(auton_registry[i].name, name) == 0){ return &auton_registry[i]; }
+  }
+  return nullptr;
+}
+
+static void run_auton(const AutonEntry &a){
+  sim::reset();
+  default_constants();
+  startMatchLog();
+  intake.start();
+  startMotorHealth();
+  if(jam_port >= 0){ vex::task jammer(jam_task); }
+  if(profile){ profiler.start(); }
+  current_auton = &a;
+  auton_finished = false;
+  auto wall_start = std::chrono::steady_clock::now();
+  sim::run(auton_period, auton_period_ms+1000);
+  bool finished = auton_finished;
+  double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-wall_start).count();
+  double sim_ms = auton_end_ms;
+  const sim::pose &p = sim::true_pose();
+  double heading = fmod(p.heading_deg, 360.0);
+  if(heading < 0){ heading += 360.0; }
+  printf("%-14s %-8s %8.0f ms sim %8.2f ms wall %7.0fx   x=%7.2f y=%7.2f heading=%7.2f\n",
+    a.name, finished ? "done" : "TIMEOUT", sim_ms, wall_ms, wall_ms > 0 ? sim_ms/wall_ms : 0,
+    p.x_in, p.y_in, heading);
+  if(jam_port >= 0){ printf("%-14s %d intake jams\n", "", intake.jams); }
+  if(profile){ profiler.report(); }
+}
+
+int main(int argc, char **argv){
+  sim::robot_config config;
+  const AutonEntry *selected[64];
+  int count = 0;
+  for(int i = 1; i < argc; i++){
+    if(strcmp(argv[i], "--list") == 0){
+      for(int i = 0; i < auton_count; i++){ printf("%s\n", auton_registry[i].name); }
+      return 0;
+    }
+    if(strcmp(argv[i], "--battery") == 0 && i+1 < argc){
+      config.battery_capacity_pct = atof(argv[++i]);
+      continue;
+    }
+    if(strcmp(argv[i], "--check") == 0){
+      sim::configure(config);
+      return run_checks();
+    }
+    if(strcmp(argv[i], "--profile") == 0){
+      profile = true;
+      continue;
+    }
+    if(strcmp(argv[i], "--jam") == 0 && i+1 < argc){
+      int port = 0;
+      unsigned ms = 0;
+      if(sscanf(argv[++i], "%d@%u", &port, &ms) != 2 || port < 1 || port > 21){
+        fprintf(stderr, "--jam takes PORT@MS, like 15@5000\n");
+        return 1;
+      }
+      jam_port = port-1;
+      jam_ms = ms;
+      continue;
+    }
+    if(strcmp(argv[i], "--sd") == 0 && i+1 < argc){
+      config.sd_card_directory = argv[++i];
+      continue;
+    }
+    const AutonEntry *a = find_auton(argv[i]);
+    if(a == nullptr){
+      fprintf(stderr, "unknown auton %s (try --list)\n", argv[i]);
+      return 1;
+    }
+    if(count < (int)(sizeof(selected)/sizeof(selected[0]))){ selected[count++] = a; }
+  }
+  if(count == 0){
+    selected[count++] = find_auton("AWP_solo");
+    selected[count++] = find_auton("leftSide");
+    selected[count++] = find_auton("rightSide");
+  }
+  sim::configure(config);
+  for(int i = 0; i < count; i++){
+    run_auton(*selected[i]);
+  }
+  return 0;
+}
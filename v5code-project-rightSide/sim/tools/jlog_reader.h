@@ -0,0 +1,144 @@
+#pragma once
+#include "vex.h"
+#include <string>
+#include <vector>
+
+/**
+ * Reader for the SD card logs written by SDLog (see sd_log.h), shared
+ * by the host log tools. open() loads a whole file and parses the
+ * header; next() then steps through frames, keeping each channel's
+ * current value and the absolute time. A file cut off mid-frame reads
+ * up to the last whole frame.
+ */
+
+struct jlog_channel {
+  std::string name;
+  float scale;
+  int32_t counts = 0;
+
+  double value() const { return counts*(double)scale; }
+};
+
+struct jlog_frame {
+  uint8_t tag;
+  int64_t time_us;
+  TelemetryRecord record;
+};
+
+class jlog_reader {
+public:
+  std::vector<jlog_channel> channels;
+  std::vector<uint8_t> data;
+  size_t offset = 0;
+  int64_t time_us = 0;
+  std::string error;
+
+  bool open(const char *path){
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr){
+      error = std::string("can't open ")+path;
+      return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while((n = fread(chunk, 1, sizeof(chunk), f)) > 0){ data.insert(data.end(), chunk, chunk+n); }
+    fclose(f);
+    if (!(byte() == 'J' && byte() == 'L' && byte() == 'O' && byte() == 'G')){
+      error = std::string(path)+" is not a JLOG file";
+      return false;
+    }
+    uint8_t version = byte();
+    if (version != SD_LOG_VERSION){
+      error = std::string(path)+" is version "+std::to_string(version)+", this reads "+std::to_string(SD_LOG_VERSION);
+      return false;
+    }
+    channels.resize(varint());
+    for(jlog_channel &c : channels){
+      c.name = string();
+      c.scale = float32();
+    }
+    if (failed){
+      error = std::string(path)+" has a truncated header";
+      return false;
+    }
+    return true;
+  }
+
+  // Reads the next frame. False at the end of the file, or at an
+  // unknown or cut off frame, which leaves remaining() nonzero.
+  bool next(jlog_frame &frame){
+    if (offset >= data.size()){ return false; }
+    size_t frame_start = offset;
+    int64_t frame_time_us = time_us;
+    frame.tag = byte();
+    frame_time_us += (int32_t)unzigzag(varint());
+    if (frame.tag == SD_LOG_SAMPLE){
+      std::vector<int32_t> counts(channels.size());
+      for(size_t i = 0; i < channels.size(); i++){
+        counts[i] = (int32_t)((uint32_t)channels[i].counts + unzigzag(varint()));
+      }
+      if (failed){ offset = frame_start; return false; }
+      for(size_t i = 0; i < channels.size(); i++){ channels[i].counts = counts[i]; }
+    } else if (frame.tag == SD_LOG_RECORD){
+      frame.record.motion_id = varint();
+      frame.record.type = byte();
+      frame.record.state = byte();
+      frame.record.error = float32();
+      frame.record.output = float32();
+      if (failed){ offset = frame_start; return false; }
+    } else {
+      offset = frame_start;
+      return false;
+    }
+    time_us = frame_time_us;
+    frame.time_us = time_us;
+    frame.record.time_us = (uint32_t)time_us;
+    return true;
+  }
+
+  size_t remaining() const { return data.size()-offset; }
+
+  int channel(const char *name) const {
+    for(size_t i = 0; i < channels.size(); i++){
+      if (channels[i].name == name){ return (int)i; }
+    }
+    return -1;
+  }
+
+private:
+  bool failed = false;
+
+  uint8_t byte(){
+    if (offset >= data.size()){ failed = true; return 0; }
+    return data[offset++];
+  }
+
+  uint32_t varint(){
+    uint32_t value = 0;
+    for(int shift = 0; shift < 35; shift += 7){
+      uint8_t b = byte();
+      value |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)){ return value; }
+    }
+    failed = true;
+    return 0;
+  }
+
+  static uint32_t unzigzag(uint32_t value){
+    return (value >> 1) ^ (0u-(value & 1));
+  }
+
+  float float32(){
+    uint32_t bits = 0;
+    for(int i = 0; i < 4; i++){ bits |= (uint32_t)byte() << (8*i); }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string string(){
+    std::string s;
+    for(uint8_t b = byte(); b != 0 && !failed; b = byte()){ s += (char)b; }
+    return s;
+  }
+};
@@ -0,0 +1,139 @@
+#include "vex.h"
+#include "jlog_reader.h"
+
+/**
+ * Decoder for the SD card logs written by SDLog (see sd_log.h).
+ * Samples come out as CSV, one row per sample with the time in
+ * seconds first; telemetry records can be listed instead. A log cut
+ * off mid-frame, e.g. by a power cycle, decodes up to the last whole
+ * frame. A summary goes to stderr. Usage:
+ *
+ *   build/sim/log_decode log_000.jlog                samples as CSV
+ *   build/sim/log_decode log_000.jlog --events       telemetry records as CSV
+ *   build/sim/log_decode log_000.jlog --columns DIR  one float64 file per channel
+ */
+
+static const char *type_name(uint8_t type){
+  switch(type){
+    case TELEMETRY_PID_TICK: return "pid";
+    case TELEMETRY_AUX_PID_TICK: return "aux";
+    case TELEMETRY_SETTLED: return "settled";
+    case TELEMETRY_MARK: return "mark";
+    case TELEMETRY_PID_CONFIG: return "pid_config";
+    case TELEMETRY_AUX_PID_CONFIG: return "aux_config";
+    case TELEMETRY_ODOM_SET: return "odom_set";
+    case TELEMETRY_ODOM_UPDATE: return "odom_update";
+    case TELEMETRY_ODOM_HEADING: return "odom_heading";
+    case TELEMETRY_ODOM_POSE: return "odom_pose";
+    case TELEMETRY_INTAKE_JAM: return "intake_jam";
+  }
+  return "unknown";
+}
+
+// Settle state for PID ticks and settle events, part number otherwise.
+static std::string state_name(uint8_t type, uint8_t state){
+  if (type == TELEMETRY_PID_TICK || type == TELEMETRY_AUX_PID_TICK || type == TELEMETRY_SETTLED){
+    switch(state){
+      case SETTLE_RUNNING: return "running";
+      case SETTLE_IN_BAND: return "in_band";
+      case SETTLE_TIMEOUT: return "timeout";
+      case SETTLE_TIME: return "settle_time";
+      case SETTLE_FLAGS: return "settle_flags";
+      case SETTLE_VELOCITY: return "settle_velocity";
+    }
+  }
+  return std::to_string(state);
+}
+
+static bool write_column(const std::string &path, const std::vector<double> &column){
+  FILE *f = fopen(path.c_str(), "wb");
+  if (f == nullptr){ return false; }
+  fwrite(column.data(), sizeof(double), column.size(), f);
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv){
+  const char *path = nullptr;
+  const char *columns_dir = nullptr;
+  bool events = false;
+  for(int i = 1; i < argc; i++){
+    if (strcmp(argv[i], "--events") == 0){ events = true; }
+    else if (strcmp(argv[i], "--columns") == 0 && i+1 < argc){ columns_dir = argv[++i]; }
+    else { path = argv[i]; }
+  }
+  if (path == nullptr){
+    fprintf(stderr, "usage: log_decode FILE [--events | --columns DIR]\n");
+    return 1;
+  }
+  jlog_reader log;
+  if (!log.open(path)){
+    fprintf(stderr, "%s\n", log.error.c_str());
+    return 1;
+  }
+  bool csv = !events && columns_dir == nullptr;
+
+  if (csv){
+    printf("time_s");
+    for(jlog_channel &c : log.channels){ printf(",%s", c.name.c_str()); }
+    printf("\n");
+  }
+  if (events){
+    printf("time_s,motion_id,type,state,error,output\n");
+  }
+
+  std::vector<double> times;
+  std::vector<std::vector<double>> columns(log.channels.size());
+  long samples = 0, records = 0;
+  size_t csv_bytes = 0;
+  jlog_frame frame;
+  while(log.next(frame)){
+    if (frame.tag == SD_LOG_SAMPLE){
+      samples++;
+      if (columns_dir != nullptr){
+        times.push_back(frame.time_us/1e6);
+        for(size_t i = 0; i < log.channels.size(); i++){ columns[i].push_back(log.channels[i].value()); }
+      }
+      char line[64];
+      csv_bytes += snprintf(line, sizeof(line), "%.6f", frame.time_us/1e6);
+      for(jlog_channel &c : log.channels){
+        csv_bytes += snprintf(line, sizeof(line), ",%g", c.value());
+      }
+      csv_bytes++;
+      if (csv){
+        printf("%.6f", frame.time_us/1e6);
+        for(jlog_channel &c : log.channels){ printf(",%g", c.value()); }
+        printf("\n");
+      }
+    } else {
+      records++;
+      if (events){
+        const TelemetryRecord &r = frame.record;
+        printf("%.6f,%u,%s,%s,%.9g,%.9g\n", frame.time_us/1e6, r.motion_id, type_name(r.type), state_name(r.type, r.state).c_str(), r.error, r.output);
+      }
+    }
+  }
+
+  if (columns_dir != nullptr){
+    bool ok = write_column(std::string(columns_dir)+"/time_s.f64", times);
+    for(size_t i = 0; i < log.channels.size(); i++){
+      ok = ok && write_column(std::string(columns_dir)+"/"+log.channels[i].name+".f64", columns[i]);
+    }
+    if (!ok){
+      fprintf(stderr, "can't write to %s\n", columns_dir);
+      return 1;
+    }
+  }
+
+  double seconds = log.time_us/1e6;
+  fprintf(stderr, "%s: %zu channels, %ld samples, %ld records over %.2f s, %zu bytes",
+    path, log.channels.size(), samples, records, seconds, log.data.size());
+  if (seconds > 0){
+    fprintf(stderr, " (%.1f KB/s; the samples alone as CSV would be %.1f KB/s)", log.offset/seconds/1000, csv_bytes/seconds/1000);
+  }
+  if (log.remaining() > 0){
+    fprintf(stderr, ", last %zu bytes cut off or unreadable", log.remaining());
+  }
+  fprintf(stderr, "\n");
+  return 0;
+}
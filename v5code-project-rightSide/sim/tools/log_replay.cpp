@@ -0,0 +1,278 @@
+#include "vex.h"
+#include "jlog_reader.h"
+#include <chrono>
+#include <map>
+#include <memory>
+
+/**
+ * Replays a match log (see sd_log.h) through Odom and PID offline.
+ * The log carries every odom input and every PID's settings and
+ * errors, so feeding them back in regenerates the pose and each
+ * controller's output; with nothing overridden they should match the
+ * robot bit for bit, and the exit status says whether they did.
+ * Overriding the odom method or the gains of the motions' main PIDs
+ * shows how the same run would have come out differently. This is
+ * open loop: the errors are the ones the robot saw, so new gains
+ * change the outputs but not what the robot did next. Usage:
+ *
+ *   build/sim/log_replay log_000.jlog                 check the replay
+ *   build/sim/log_replay log_000.jlog --method pilons replay with PILONS_ARC
+ *   build/sim/log_replay log_000.jlog --kp 2 --kd 12  replay with new gains
+ *   build/sim/log_replay log_000.jlog --trace odom    CSV of poses, logged and replayed
+ *   build/sim/log_replay log_000.jlog --trace pid     CSV of outputs, logged and replayed
+ */
+
+struct overrides {
+  bool method_set = false;
+  odom_method method = ROTATED_ARC;
+  float kp = NAN, ki = NAN, kd = NAN, derivative_filter = NAN;
+};
+
+struct controller_replay {
+  float parts[5][2];
+  int parts_seen = 0;
+  std::unique_ptr<PID> pid;
+  uint16_t motion_id = 0;
+};
+
+struct comparison {
+  long count = 0;
+  long identical = 0;
+  double worst = 0;
+
+  void add(float logged, float replayed){
+    count++;
+    if (memcmp(&logged, &replayed, sizeof(float)) == 0){ identical++; }
+    worst = fmax(worst, fabs((double)logged-replayed));
+  }
+};
+
+static const char *settle_name(uint8_t state){
+  switch(state){
+    case SETTLE_TIMEOUT: return "timeout";
+    case SETTLE_TIME: return "settle_time";
+    case SETTLE_FLAGS: return "settle_flags";
+    case SETTLE_VELOCITY: return "settle_velocity";
+  }
+  return "not settled";
+}
+
+class replay {
+public:
+  overrides options;
+  bool trace_odom = false;
+  bool trace_pid = false;
+
+  Odom odom;
+  bool odom_ready = false;
+  float odom_set[4][2];
+  float tracker_forward = 0, tracker_sideways = 0;
+  long odom_resets = 0;
+  comparison odom_poses;
+
+  controller_replay controllers[2];
+  long controllers_started[2] = {0, 0};
+  long unmatched_ticks = 0;
+  comparison pid_outputs;
+  std::map<uint16_t, uint8_t> logged_settles;
+  std::map<uint16_t, float> logged_settle_velocities;
+  std::map<uint16_t, uint8_t> replayed_settles;
+
+  void record(int64_t time_us, const TelemetryRecord &r){
+    switch(r.type){
+      case TELEMETRY_ODOM_SET: odom_set_part(r); break;
+      case TELEMETRY_ODOM_UPDATE:
+        tracker_forward = r.error;
+        tracker_sideways = r.output;
+        break;
+      case TELEMETRY_ODOM_HEADING:
+        if (odom_ready){ odom.update_position(tracker_forward, tracker_sideways, r.error); }
+        break;
+      case TELEMETRY_ODOM_POSE:
+        if (odom_ready){
+          odom_poses.add(r.error, odom.X_position);
+          odom_poses.add(r.output, odom.Y_position);
+          if (trace_odom){
+            printf("%.6f,%.9g,%.9g,%.9g,%.9g\n", time_us/1e6, r.error, r.output, odom.X_position, odom.Y_position);
+          }
+        }
+        break;
+      case TELEMETRY_PID_CONFIG: config_part(controllers[0], 0, r); break;
+      case TELEMETRY_AUX_PID_CONFIG: config_part(controllers[1], 1, r); break;
+      case TELEMETRY_PID_TICK: tick(controllers[0], 0, time_us, r); break;
+      case TELEMETRY_AUX_PID_TICK: tick(controllers[1], 1, time_us, r); break;
+      case TELEMETRY_SETTLED:
+        logged_settles[r.motion_id] = r.state;
+        if (r.state == SETTLE_VELOCITY){ logged_settle_velocities[r.motion_id] = r.output; }
+        break;
+    }
+  }
+
+  // Settles whatever is still running once the log ends.
+  void finish(){
+    settle(controllers[0]);
+  }
+
+private:
+  void odom_set_part(const TelemetryRecord &r){
+    if (r.state > 3){ return; }
+    odom_set[r.state][0] = r.error;
+    odom_set[r.state][1] = r.output;
+    if (r.state != 3){ return; }
+    odom.set_physical_distances(odom_set[3][0], odom_set[3][1]);
+    odom.method = options.method_set ? options.method : (odom_method)(int)odom_set[2][1];
+    odom.set_position(odom_set[0][0], odom_set[0][1], odom_set[1][0], odom_set[1][1], odom_set[2][0]);
+    odom_ready = true;
+    odom_resets++;
+  }
+
+  void config_part(controller_replay &c, int source, const TelemetryRecord &r){
+    if (r.state == 0){
+      if (source == 0){ settle(c); }
+      c.pid.reset();
+      c.parts_seen = 0;
+    }
+    // Logs from before velocity settling stop at part 4, and ones from
+    // before settle_velocity_count settled on the first slow tick.
+    if (r.state == 5 && c.parts_seen == 5 && c.pid){
+      c.pid->settle_velocity = r.error;
+      c.pid->settle_velocity_count = (r.output > 0) ? (int)r.output : 1;
+      return;
+    }
+    if (r.state != c.parts_seen || r.state > 4){ return; }
+    c.parts[r.state][0] = r.error;
+    c.parts[r.state][1] = r.output;
+    c.parts_seen++;
+    if (c.parts_seen < 5){ return; }
+    float (*p)[2] = c.parts;
+    float kp = p[0][0], ki = p[0][1], kd = p[1][0];
+    float derivative_filter = p[4][0];
+    if (source == 0){
+      if (!isnan(options.kp)){ kp = options.kp; }
+      if (!isnan(options.ki)){ ki = options.ki; }
+      if (!isnan(options.kd)){ kd = options.kd; }
+      if (!isnan(options.derivative_filter)){ derivative_filter = options.derivative_filter; }
+    }
+    c.pid.reset(new PID(0, kp, ki, kd, p[1][1], p[2][0], p[2][1], p[3][0], p[3][1], (int)p[4][1]));
+    c.pid->derivative_filter = derivative_filter;
+    c.pid->telemetry_source = source == 0 ? TELEMETRY_PID_TICK : TELEMETRY_AUX_PID_TICK;
+    c.motion_id = r.motion_id;
+    controllers_started[source]++;
+  }
+
+  void tick(controller_replay &c, int source, int64_t time_us, const TelemetryRecord &r){
+    if (!c.pid){
+      unmatched_ticks++;
+      return;
+    }
+    float output = c.pid->compute(r.error, (uint64_t)time_us);
+    pid_outputs.add(r.output, output);
+    if (trace_pid){
+      printf("%.6f,%u,%s,%.9g,%.9g,%.9g\n", time_us/1e6, r.motion_id, source == 0 ? "pid" : "aux", r.error, r.output, output);
+    }
+    discard_telemetry();
+  }
+
+  // Asks a finished main controller whether it has settled, and why,
+  // which it answers through telemetry like on the robot.
+  void settle(controller_replay &c){
+    if (!c.pid){ return; }
+    discard_telemetry();
+    // Velocity is only logged when it ends a motion, so that's what
+    // the replay checks a velocity settle against.
+    auto velocity = logged_settle_velocities.find(c.motion_id);
+    if (velocity != logged_settle_velocities.end()){ c.pid->velocity = velocity->second; }
+    uint8_t reason = SETTLE_RUNNING;
+    if (c.pid->is_settled()){
+      TelemetryRecord r;
+      while(telemetry.pop(r)){
+        if (r.type == TELEMETRY_SETTLED){ reason = r.state; }
+      }
+    }
+    replayed_settles[c.motion_id] = reason;
+    c.pid.reset();
+  }
+
+  // The PIDs log their own ticks as they replay; nothing reads them.
+  static void discard_telemetry(){
+    TelemetryRecord r;
+    while(telemetry.pop(r)){}
+  }
+};
+
+int main(int argc, char **argv){
+  const char *path = nullptr;
+  replay r;
+  bool overridden = false;
+  for(int i = 1; i < argc; i++){
+    const char *arg = argv[i];
+    bool has_value = i+1 < argc;
+    if (strcmp(arg, "--method") == 0 && has_value){
+      const char *method = argv[++i];
+      r.options.method_set = true;
+      r.options.method = (strcmp(method, "pilons") == 0) ? PILONS_ARC : ROTATED_ARC;
+      overridden = true;
+    }
+    else if (strcmp(arg, "--kp") == 0 && has_value){ r.options.kp = atof(argv[++i]); overridden = true; }
+    else if (strcmp(arg, "--ki") == 0 && has_value){ r.options.ki = atof(argv[++i]); overridden = true; }
+    else if (strcmp(arg, "--kd") == 0 && has_value){ r.options.kd = atof(argv[++i]); overridden = true; }
+    else if (strcmp(arg, "--derivative-filter") == 0 && has_value){ r.options.derivative_filter = atof(argv[++i]); overridden = true; }
+    else if (strcmp(arg, "--trace") == 0 && has_value){
+      const char *what = argv[++i];
+      r.trace_odom = strcmp(what, "odom") == 0;
+      r.trace_pid = strcmp(what, "pid") == 0;
+    }
+    else { path = arg; }
+  }
+  if (path == nullptr){
+    fprintf(stderr, "usage: log_replay FILE [--method pilons|rotated] [--kp F] [--ki F] [--kd F] [--derivative-filter F] [--trace odom|pid]\n");
+    return 2;
+  }
+  jlog_reader log;
+  if (!log.open(path)){
+    fprintf(stderr, "%s\n", log.error.c_str());
+    return 2;
+  }
+  if (r.trace_odom){ printf("time_s,logged_X,logged_Y,replayed_X,replayed_Y\n"); }
+  if (r.trace_pid){ printf("time_s,motion_id,controller,error,logged_output,replayed_output\n"); }
+
+  auto start = std::chrono::steady_clock::now();
+  jlog_frame frame;
+  while(log.next(frame)){
+    if (frame.tag == SD_LOG_RECORD){ r.record(frame.time_us, frame.record); }
+  }
+  r.finish();
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  double log_s = log.time_us/1e6;
+
+  long settles_compared = 0, settles_same = 0;
+  for(auto &logged : r.logged_settles){
+    auto replayed = r.replayed_settles.find(logged.first);
+    if (replayed == r.replayed_settles.end()){ continue; }
+    settles_compared++;
+    if (replayed->second == logged.second){ settles_same++; }
+    else if (!r.trace_odom && !r.trace_pid){
+      fprintf(stderr, "motion %u: logged %s, replayed %s\n", logged.first, settle_name(logged.second), settle_name(replayed->second));
+    }
+  }
+
+  fprintf(stderr, "%s: %.2f s of log replayed in %.2f ms (%.0fx real time)\n", path, log_s, wall_s*1000, wall_s > 0 ? log_s/wall_s : 0);
+  fprintf(stderr, "odom:   %ld resets, %ld poses, %ld/%ld coordinates bit identical, worst difference %.3g in\n",
+    r.odom_resets, r.odom_poses.count/2, r.odom_poses.identical, r.odom_poses.count, r.odom_poses.worst);
+  fprintf(stderr, "pid:    %ld main and %ld aux controllers, %ld/%ld outputs bit identical, worst difference %.3g\n",
+    r.controllers_started[0], r.controllers_started[1], r.pid_outputs.identical, r.pid_outputs.count, r.pid_outputs.worst);
+  fprintf(stderr, "settle: %ld/%ld main controllers settled the same way\n", settles_same, settles_compared);
+  if (r.unmatched_ticks > 0){
+    fprintf(stderr, "%ld PID ticks came before their controller's settings and were skipped\n", r.unmatched_ticks);
+  }
+  int dropped_channel = log.channel("telemetry_dropped");
+  if (dropped_channel >= 0 && log.channels[dropped_channel].counts > 0){
+    fprintf(stderr, "the robot dropped %d telemetry records, so the replay has gaps\n", log.channels[dropped_channel].counts);
+  }
+  if (log.remaining() > 0){
+    fprintf(stderr, "last %zu bytes cut off or unreadable\n", log.remaining());
+  }
+
+  bool exact = r.odom_poses.identical == r.odom_poses.count && r.pid_outputs.identical == r.pid_outputs.count && settles_same == settles_compared;
+  return (overridden || exact) ? 0 : 1;
+}
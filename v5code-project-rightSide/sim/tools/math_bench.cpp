@@ -0,0 +1,213 @@
+#include "vex.h"
+#include <chrono>
+#include <string.h>
+
+/**
+ * Angle and trig library benchmark. Walks every float in each
+ * function's working range (or every Nth one), checking the reduce_*
+ * functions against a double precision reference and the fast trig
+ * against libm, checks that the batch versions match the scalar ones
+ * (bit for bit for sin and cos, and up to the sign of a zero for the
+ * reductions), and times everything next to the loops and libm calls
+ * they replace. Built with the NEON code paths switched on through
+ * the host stand-in for arm_neon.h. Usage:
+ *
+ *   build/sim/math_bench               every 16th float
+ *   build/sim/math_bench 1             every float
+ */
+
+// The reduce functions as they were, for timing against.
+static float loop_reduce_0_to_360(float angle){
+  while(!(angle >= 0 && angle < 360)) {
+    if( angle < 0 ) { angle += 360; }
+    if(angle >= 360) { angle -= 360; }
+  }
+  return(angle);
+}
+
+static float loop_reduce_negative_180_to_180(float angle){
+  while(!(angle >= -180 && angle < 180)) {
+    if( angle < -180 ) { angle += 360; }
+    if(angle >= 180) { angle -= 360; }
+  }
+  return(angle);
+}
+
+static uint32_t float_bits(float x){
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+/**
+ * Calls visit() on every stride-th float in [-limit, limit], going
+ * outward from zero through the bit patterns.
+ */
+
+template <typename F>
+static void for_each_float(float limit, uint32_t stride, F visit){
+  uint32_t last = float_bits(limit);
+  for(uint64_t bits = 0; bits <= last; bits += stride){
+    float x;
+    uint32_t b = (uint32_t)bits;
+    memcpy(&x, &b, sizeof(x));
+    visit(x);
+    visit(-x);
+  }
+}
+
+struct error_stats {
+  double worst = 0;
+  float worst_input = 0;
+  long out_of_range = 0;
+  long checked = 0;
+
+  void add(float input, double error){
+    checked++;
+    if (error > worst){ worst = error; worst_input = input; }
+  }
+};
+
+/**
+ * Reference reduction in double. Exact for every float input, since
+ * fmod is exact and the result fits in a double.
+ */
+
+static double exact_reduce(float angle, double low, double period){
+  double reduced = fmod((double)angle - low, period);
+  if (reduced < 0){ reduced += period; }
+  return reduced + low;
+}
+
+static void check_reduce(const char *name, float (*reduce)(float), double low, double period, float limit, uint32_t stride){
+  error_stats stats;
+  for_each_float(limit, stride, [&](float x){
+    float r = reduce(x);
+    if (!(r >= low && r < low+period)){ stats.out_of_range++; }
+    double error = fabs(r - exact_reduce(x, low, period));
+    error = fmin(error, fabs(error-period));
+    stats.add(x, error);
+  });
+  printf("%-28s |x|<=%-8g %10ld checked  worst %.3g deg at %g  %ld out of range\n",
+    name, limit, stats.checked, stats.worst, stats.worst_input, stats.out_of_range);
+}
+
+static void check_trig(float limit, uint32_t stride){
+  error_stats sin_stats, cos_stats;
+  for_each_float(limit, stride, [&](float x){
+    float s, c;
+    fast_sincos(x, s, c);
+    sin_stats.add(x, fabs(s - sin((double)x)));
+    cos_stats.add(x, fabs(c - cos((double)x)));
+  });
+  printf("%-28s |x|<=%-8g %10ld checked  worst %.3g at %g\n", "fast_sin", limit, sin_stats.checked, sin_stats.worst, sin_stats.worst_input);
+  printf("%-28s |x|<=%-8g %10ld checked  worst %.3g at %g\n", "fast_cos", limit, cos_stats.checked, cos_stats.worst, cos_stats.worst_input);
+}
+
+static void check_atan2(){
+  error_stats stats;
+  const int steps = 1<<20;
+  for(int i = 0; i < steps; i++){
+    double angle = -M_PI + 2*M_PI*i/steps;
+    for(float radius : {1e-3f, 1.0f, 1e4f}){
+      float y = radius*sin(angle);
+      float x = radius*cos(angle);
+      double error = fabs(fast_atan2(y, x) - atan2((double)y, (double)x));
+      stats.add(angle, fmin(error, fabs(error-2*M_PI)));
+    }
+  }
+  printf("%-28s %-14s %10ld checked  worst %.3g rad at %g\n", "fast_atan2", "full circle", stats.checked, stats.worst, stats.worst_input);
+}
+
+/**
+ * Runs the batch versions over chunks of the range, including a
+ * ragged tail, and counts any output that isn't bit identical to
+ * the scalar version.
+ */
+
+static void check_batch(float limit, uint32_t stride){
+  const int chunk = 1023;
+  static float input[chunk], batch[chunk], batch_cos[chunk], scalar[chunk], scalar_cos[chunk];
+  long mismatches[3] = {0, 0, 0};
+  long checked = 0;
+  int n = 0;
+  auto flush = [&](){
+    memcpy(batch, input, n*sizeof(float));
+    reduce_0_to_360_batch(batch, n);
+    for(int i = 0; i < n; i++){ mismatches[0] += batch[i] != reduce_0_to_360(input[i]); }
+    memcpy(batch, input, n*sizeof(float));
+    reduce_negative_180_to_180_batch(batch, n);
+    for(int i = 0; i < n; i++){ mismatches[1] += batch[i] != reduce_negative_180_to_180(input[i]); }
+    fast_sincos_batch(input, batch, batch_cos, n);
+    for(int i = 0; i < n; i++){
+      fast_sincos(input[i], scalar[i], scalar_cos[i]);
+      mismatches[2] += float_bits(batch[i]) != float_bits(scalar[i]) || float_bits(batch_cos[i]) != float_bits(scalar_cos[i]);
+    }
+    checked += n;
+    n = 0;
+  };
+  for_each_float(limit, stride, [&](float x){
+    input[n++] = x;
+    if (n == chunk){ flush(); }
+  });
+  flush();
+  printf("batch vs scalar              %10ld checked  mismatches: 0..360 %ld, -180..180 %ld, sincos %ld\n",
+    checked, mismatches[0], mismatches[1], mismatches[2]);
+}
+
+template <typename F>
+static double time_ns(const float *input, int count, int repeats, F f){
+  volatile float sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int r = 0; r < repeats; r++){
+    float sum = 0;
+    for(int i = 0; i < count; i++){ sum += f(input[i]); }
+    sink = sink + sum;
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/((double)count*repeats);
+}
+
+/**
+ * Times each function over headings like the IMU's rotation(), which
+ * grow without bound over a match: a few turns either way, and the
+ * same spread of values after forty turns of spinning.
+ */
+
+static void time_all(){
+  const int count = 4096;
+  const int repeats = 500;
+  static float near_zero[count], far[count], radians[count], work[count], sin_out[count], cos_out[count];
+  for(int i = 0; i < count; i++){
+    near_zero[i] = -1080 + 2160.0f*((i*2654435761u)%count)/count;
+    far[i] = near_zero[i] + 14400;
+    radians[i] = to_rad(near_zero[i]);
+  }
+  printf("\n%-34s %10s %10s\n", "ns/call", "+-3 turns", "40 turns");
+  printf("%-34s %10.2f %10.2f\n", "reduce_0_to_360 (loop)",
+    time_ns(near_zero, count, repeats, loop_reduce_0_to_360), time_ns(far, count, repeats/10, loop_reduce_0_to_360));
+  printf("%-34s %10.2f %10.2f\n", "reduce_0_to_360",
+    time_ns(near_zero, count, repeats, reduce_0_to_360), time_ns(far, count, repeats, reduce_0_to_360));
+  printf("%-34s %10.2f %10.2f\n", "reduce_negative_180_to_180 (loop)",
+    time_ns(near_zero, count, repeats, loop_reduce_negative_180_to_180), time_ns(far, count, repeats/10, loop_reduce_negative_180_to_180));
+  printf("%-34s %10.2f %10.2f\n", "reduce_negative_180_to_180",
+    time_ns(near_zero, count, repeats, reduce_negative_180_to_180), time_ns(far, count, repeats, reduce_negative_180_to_180));
+  printf("%-34s %10.2f\n", "sinf + cosf", time_ns(radians, count, repeats, [](float x){ return sinf(x) + cosf(x); }));
+  printf("%-34s %10.2f\n", "fast_sincos", time_ns(radians, count, repeats, [](float x){ float s, c; fast_sincos(x, s, c); return s + c; }));
+  printf("%-34s %10.2f\n", "atan2f", time_ns(radians, count, repeats, [](float x){ return atan2f(x, 1.5f); }));
+  printf("%-34s %10.2f\n", "fast_atan2", time_ns(radians, count, repeats, [](float x){ return fast_atan2(x, 1.5f); }));
+  printf("(batch timings on the host measure the NEON stand-in, not NEON)\n");
+  (void)work; (void)sin_out; (void)cos_out;
+}
+
+int main(int argc, char **argv){
+  uint32_t stride = 16;
+  if (argc > 1){ stride = (uint32_t)fmax(1, atoi(argv[1])); }
+  check_reduce("reduce_0_to_360", reduce_0_to_360, 0, 360, 1e6, stride);
+  check_reduce("reduce_negative_180_to_180", reduce_negative_180_to_180, -180, 360, 1e6, stride);
+  check_reduce("reduce_negative_90_to_90", reduce_negative_90_to_90, -90, 180, 1e6, stride);
+  check_trig(1e4, stride);
+  check_atan2();
+  check_batch(1e4, stride);
+  time_all();
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "vex.h"
+#include "sim.h"
+#include <chrono>
+#include <random>
+
+/**
+ * Odometry kernel benchmark. Drives a random sequence of constant
+ * speed arcs (with some sideways slip for the sideways tracker),
+ * feeds exact tracker and heading readings to Odom at a given rate,
+ * and compares the result with the analytic pose. Also times each
+ * kernel's update_position(). Usage:
+ *
+ *   build/sim/odom_bench               200Hz and 1kHz, 20 runs of 15s
+ *   build/sim/odom_bench 500 ...       the given rates in Hz
+ */
+
+static const float ForwardTracker_center_distance = 1.5;
+static const float SidewaysTracker_center_distance = 3.0;
+
+struct truth_pose {
+  double X = 0;
+  double Y = 0;
+  double theta = 0;
+  double forward = 0;
+  double sideways = 0;
+};
+
+struct arc {
+  double velocity;
+  double slip;
+  double omega;
+  double duration;
+};
+
+/**
+ * Moves the ground truth along an arc for dt seconds. Tracker
+ * travel is linear in time for a constant arc, so it's exact too.
+ */
+
+static void advance(truth_pose &p, const arc &a, double dt){
+  double theta1 = p.theta+a.omega*dt;
+  double int_sin, int_cos;
+  if (fabs(a.omega) < 1e-9){
+    int_sin = sin(p.theta)*dt;
+    int_cos = cos(p.theta)*dt;
+  } else {
+    int_sin = (cos(p.theta)-cos(theta1))/a.omega;
+    int_cos = (sin(theta1)-sin(p.theta))/a.omega;
+  }
+  p.X += a.velocity*int_sin + a.slip*int_cos;
+  p.Y += a.velocity*int_cos - a.slip*int_sin;
+  p.forward += a.velocity*dt - ForwardTracker_center_distance*a.omega*dt;
+  p.sideways += a.slip*dt - SidewaysTracker_center_distance*a.omega*dt;
+  p.theta = theta1;
+}
+
+static double heading_deg(const truth_pose &p){
+  double deg = fmod(p.theta*180.0/M_PI, 360.0);
+  return deg < 0 ? deg+360.0 : deg;
+}
+
+struct run_result {
+  double final_error = 0;
+  double max_error = 0;
+};
+
+static run_result run_route(odom_method method, double rate_hz, double seconds, unsigned seed){
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> velocity(-60, 60);
+  std::uniform_real_distribution<double> slip(-4, 4);
+  std::uniform_real_distribution<double> omega(-7, 7);
+  std::uniform_real_distribution<double> duration(0.1, 1.2);
+
+  Odom odom;
+  odom.method = method;
+  odom.set_physical_distances(ForwardTracker_center_distance, SidewaysTracker_center_distance);
+  odom.set_position(0, 0, 0, 0, 0);
+
+  truth_pose truth;
+  run_result result;
+  double dt = 1.0/rate_hz;
+  double time = 0;
+  arc current = {velocity(rng), slip(rng), omega(rng), duration(rng)};
+  double arc_left = current.duration;
+  while(time < seconds){
+    // Arcs change between samples, not on them.
+    double step_left = dt;
+    while(step_left > 0){
+      double step = fmin(step_left, arc_left);
+      advance(truth, current, step);
+      step_left -= step;
+      arc_left -= step;
+      if (arc_left <= 0){
+        current = {velocity(rng), slip(rng), omega(rng), duration(rng)};
+        arc_left = current.duration;
+      }
+    }
+    time += dt;
+    odom.update_position(truth.forward, truth.sideways, heading_deg(truth));
+    OdomPose pose = odom.get_pose();
+    double error = hypot(pose.X_position-truth.X, pose.Y_position-truth.Y);
+    result.max_error = fmax(result.max_error, error);
+    result.final_error = error;
+  }
+  return result;
+}
+
+static double time_updates(odom_method method){
+  const int samples = 4096;
+  static float forward[samples], sideways[samples], heading[samples];
+  truth_pose truth;
+  arc a = {40, 1, 3, 0};
+  for(int i = 0; i < samples; i++){
+    if (i%256 == 0){ a.omega = -a.omega; }
+    advance(truth, a, 0.001);
+    forward[i] = truth.forward;
+    sideways[i] = truth.sideways;
+    heading[i] = heading_deg(truth);
+  }
+  Odom odom;
+  odom.method = method;
+  odom.set_physical_distances(ForwardTracker_center_distance, SidewaysTracker_center_distance);
+  const int updates = 4000000;
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < updates; i++){
+    int j = i&(samples-1);
+    if (j == 0){ odom.set_position(0, 0, heading[0], forward[0], sideways[0]); }
+    odom.update_position(forward[j], sideways[j], heading[j]);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count();
+  volatile float sink = odom.X_position;
+  (void)sink;
+  return ns/updates;
+}
+
+int main(int argc, char **argv){
+  double rates[8] = {200, 1000};
+  int rate_count = 2;
+  if (argc > 1){
+    rate_count = 0;
+    for(int i = 1; i < argc && rate_count < 8; i++){ rates[rate_count++] = atof(argv[i]); }
+  }
+  const int runs = 20;
+  const double seconds = 15;
+  const odom_method methods[2] = {PILONS_ARC, ROTATED_ARC};
+  const char *names[2] = {"PILONS_ARC", "ROTATED_ARC"};
+
+  printf("%-12s %8s %14s %14s %14s\n", "method", "rate", "mean final in", "worst final in", "worst any in");
+  for(int r = 0; r < rate_count; r++){
+    for(int m = 0; m < 2; m++){
+      double final_sum = 0, final_worst = 0, any_worst = 0;
+      for(int run = 0; run < runs; run++){
+        run_result result = run_route(methods[m], rates[r], seconds, 1000+run);
+        final_sum += result.final_error;
+        final_worst = fmax(final_worst, result.final_error);
+        any_worst = fmax(any_worst, result.max_error);
+      }
+      printf("%-12s %6.0fHz %14.4f %14.4f %14.4f\n", names[m], rates[r], final_sum/runs, final_worst, any_worst);
+    }
+  }
+  printf("\n");
+  for(int m = 0; m < 2; m++){
+    printf("%-12s %8.1f ns/update\n", names[m], time_updates(methods[m]));
+  }
+  return 0;
+}
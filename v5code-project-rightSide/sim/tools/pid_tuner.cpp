@@ -0,0 +1,426 @@
+#include "vex.h"
+#include "sim.h"
+#include <chrono>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * PID gain tuner. Runs a set of test moves for each controller in the
+ * simulator and pattern-searches kP, kI, kD and startI to minimise
+ * the time the moves take plus penalties for overshoot and for where
+ * they end up, starting from default_constants(). Each round tries
+ * every combination of one step up, down or unchanged for each gain,
+ * spread over worker processes (the simulator is single threaded),
+ * and halves the steps when nothing beats the current gains. Max
+ * voltages, exit conditions and everything else stay as they are in
+ * default_constants(). Prints a block to paste back in. With
+ * --schedule it instead tunes drive, turn and swing separately for each
+ * test move size, max voltage included, and prints gain schedule
+ * tables. Each controller is tuned with the others at their defaults,
+ * so a final pass reruns every test move with all the tuned gains
+ * installed together and reports that score next to the defaults'.
+ * Usage:
+ *
+ *   build/sim/pid_tuner                    tunes turn, swing, drive, heading
+ *   build/sim/pid_tuner --schedule         tunes gain schedules
+ *   build/sim/pid_tuner turn swing         tunes just those
+ *   build/sim/pid_tuner --jobs 8           worker processes (default: all cores)
+ *   build/sim/pid_tuner --rounds 30        search rounds per controller (default 20)
+ *   build/sim/pid_tuner --no-integral      keeps kI and startI fixed
+ *   build/sim/pid_tuner --battery 60       tunes at 60% charge
+ */
+
+enum controller_kind {TURN, SWING, DRIVE, HEADING};
+static const char *controller_names[] = {"turn", "swing", "drive", "heading"};
+
+struct gains {
+  float max_voltage, kp, ki, kd, starti;
+};
+
+struct test_move {
+  controller_kind kind;
+  float target;
+  float heading;
+};
+
+// Turns and swings are to absolute angles from 0; drives go straight
+// ahead, and the heading moves also turn to a new heading on the way.
+static const test_move test_moves[] = {
+  {TURN, 15, 0}, {TURN, 90, 0}, {TURN, 180, 0}, {TURN, -45, 0},
+  {SWING, 90, 0}, {SWING, -45, 0},
+  {DRIVE, 2, 0}, {DRIVE, 6, 0}, {DRIVE, 24, 0}, {DRIVE, 48, 0}, {DRIVE, -24, 0},
+  {HEADING, 36, 20}, {HEADING, 24, -45},
+};
+
+// Penalties in ms per inch (drive) or degree (the rest).
+static const double overshoot_weight[] = {20, 20, 100, 0};
+static const double final_error_weight[] = {40, 40, 200, 50};
+static const double heading_error_weight = 50;
+static const double unfinished_penalty_ms = 10000;
+static const uint32_t move_limit_ms = 10000;
+
+static test_move current_move;
+static std::vector<TelemetryRecord> collected;
+
+// Sets the constants under test. The setters also turn off any gain
+// schedule that would override them.
+static void apply(controller_kind kind, const gains &g){
+  switch(kind){
+    case TURN: chassis.set_turn_constants(g.max_voltage, g.kp, g.ki, g.kd, g.starti); break;
+    case SWING: chassis.set_swing_constants(g.max_voltage, g.kp, g.ki, g.kd, g.starti); break;
+    case DRIVE: chassis.set_drive_constants(g.max_voltage, g.kp, g.ki, g.kd, g.starti); break;
+    case HEADING: chassis.set_heading_constants(g.max_voltage, g.kp, g.ki, g.kd, g.starti); break;
+  }
+}
+
+static gains current_gains(controller_kind kind){
+  switch(kind){
+    case TURN: return {chassis.turn_max_voltage, chassis.turn_kp, chassis.turn_ki, chassis.turn_kd, chassis.turn_starti};
+    case SWING: return {chassis.swing_max_voltage, chassis.swing_kp, chassis.swing_ki, chassis.swing_kd, chassis.swing_starti};
+    case DRIVE: return {chassis.drive_max_voltage, chassis.drive_kp, chassis.drive_ki, chassis.drive_kd, chassis.drive_starti};
+    case HEADING: return {chassis.heading_max_voltage, chassis.heading_kp, chassis.heading_ki, chassis.heading_kd, chassis.heading_starti};
+  }
+  return {0, 0, 0, 0, 0};
+}
+
+// Keeps every PID tick, for overshoot and final error.
+static int collect_telemetry(){
+  while(true){
+    TelemetryRecord r;
+    while(telemetry.pop(r)){ collected.push_back(r); }
+    vex::task::sleep(5);
+  }
+  return 0;
+}
+
+static void run_move(){
+  vex::task collector(collect_telemetry);
+  const test_move &m = current_move;
+  switch(m.kind){
+    case TURN: chassis.turn_to_angle(m.target); break;
+    case SWING:
+      if(m.target > 0){ chassis.left_swing_to_angle(m.target); }
+      else { chassis.right_swing_to_angle(m.target); }
+      break;
+    case DRIVE: chassis.drive_distance(m.target); break;
+    case HEADING: chassis.drive_distance(m.target, m.heading); break;
+  }
+}
+
+/**
+ * Runs one test move from rest with whatever constants are set and
+ * scores it: the time it took, plus overshoot past the target and the
+ * error left at the end, both from the main PID's ticks. Heading
+ * moves score the heading PID's average and final error instead.
+ */
+
+static double run_and_score(const test_move &m, controller_kind kind){
+  TelemetryRecord r;
+  while(telemetry.pop(r)){}
+  collected.clear();
+  current_move = m;
+  bool finished = sim::run(run_move, move_limit_ms);
+  while(telemetry.pop(r)){ collected.push_back(r); }
+
+  double cost = sim::now_us()/1000.0;
+  if(!finished){ cost += unfinished_penalty_ms; }
+  float start_error = 0, last_error = 0, overshoot = 0;
+  bool started = false;
+  double heading_error_sum = 0, last_heading_error = 0;
+  int heading_ticks = 0;
+  for(const TelemetryRecord &t : collected){
+    if(t.type == TELEMETRY_PID_TICK){
+      if(!started){ start_error = t.error; started = true; }
+      float past = (start_error > 0) ? -t.error : t.error;
+      overshoot = fmax(overshoot, past);
+      last_error = t.error;
+    }
+    if(t.type == TELEMETRY_AUX_PID_TICK){
+      heading_error_sum += fabs(t.error);
+      last_heading_error = t.error;
+      heading_ticks++;
+    }
+  }
+  if(kind == HEADING){
+    if(heading_ticks > 0){ cost += heading_error_weight*heading_error_sum/heading_ticks; }
+    cost += final_error_weight[kind]*fabs(last_heading_error);
+  } else {
+    cost += overshoot_weight[kind]*overshoot + final_error_weight[kind]*fabs(last_error);
+  }
+  return cost;
+}
+
+static double score_move(const test_move &m, controller_kind kind, const gains &g){
+  sim::reset();
+  default_constants();
+  apply(kind, g);
+  return run_and_score(m, kind);
+}
+
+/**
+ * Scores every test move with all of the given gains installed at
+ * once, or default_constants() alone if there are none, and prints
+ * the total for each controller.
+ *
+ * @param label Name for the printed line.
+ * @param tuned Constant sets by controller_kind, or nullptr.
+ * @param schedules Gain schedule rows by controller_kind, or nullptr.
+ * @return Total cost over every test move.
+ */
+
+static double validate(const char *label, const gains *tuned, const std::vector<GainPoint> *schedules){
+  double cost[4] = {0, 0, 0, 0};
+  for(const test_move &m : test_moves){
+    sim::reset();
+    default_constants();
+    for(int k = 0; tuned && k < 4; k++){ apply((controller_kind)k, tuned[k]); }
+    GainSchedule installed[3];
+    for(int k = 0; schedules && k < 3; k++){
+      installed[k].points = schedules[k].data();
+      installed[k].count = schedules[k].size();
+    }
+    if(schedules){
+      chassis.set_turn_schedule(installed[TURN].count > 0 ? &installed[TURN] : nullptr);
+      chassis.set_swing_schedule(installed[SWING].count > 0 ? &installed[SWING] : nullptr);
+      chassis.set_drive_schedule(installed[DRIVE].count > 0 ? &installed[DRIVE] : nullptr);
+    }
+    cost[m.kind] += run_and_score(m, m.kind);
+  }
+  double total = cost[0]+cost[1]+cost[2]+cost[3];
+  printf("%-10s %9.1f  turn %.1f swing %.1f drive %.1f heading %.1f\n", label, total, cost[TURN], cost[SWING], cost[DRIVE], cost[HEADING]);
+  return total;
+}
+
+// Size 0 scores every test move of the kind, otherwise just the ones
+// of that size.
+static double evaluate(controller_kind kind, float size, const gains &g){
+  double total = 0;
+  for(const test_move &m : test_moves){
+    if(m.kind == kind && (size == 0 || fabs(m.target) == size)){ total += score_move(m, kind, g); }
+  }
+  return total;
+}
+
+/**
+ * Scores each candidate, in jobs forked worker processes. Each worker
+ * takes every jobs-th candidate and sends back (index, cost) pairs.
+ */
+
+static std::vector<double> evaluate_all(controller_kind kind, float size, const std::vector<gains> &candidates, int jobs){
+  std::vector<double> costs(candidates.size(), INFINITY);
+  if(jobs <= 1){
+    for(size_t i = 0; i < candidates.size(); i++){ costs[i] = evaluate(kind, size, candidates[i]); }
+    return costs;
+  }
+  fflush(stdout);
+  std::vector<int> pipes;
+  std::vector<pid_t> workers;
+  for(int w = 0; w < jobs && w < (int)candidates.size(); w++){
+    int fds[2];
+    if(pipe(fds) != 0){ break; }
+    pid_t child = fork();
+    if(child == 0){
+      close(fds[0]);
+      for(size_t i = w; i < candidates.size(); i += jobs){
+        double result[2] = {(double)i, evaluate(kind, size, candidates[i])};
+        if(write(fds[1], result, sizeof(result)) != sizeof(result)){ _exit(1); }
+      }
+      _exit(0);
+    }
+    close(fds[1]);
+    if(child < 0){
+      close(fds[0]);
+      break;
+    }
+    pipes.push_back(fds[0]);
+    workers.push_back(child);
+  }
+  for(int fd : pipes){
+    double result[2];
+    while(read(fd, result, sizeof(result)) == sizeof(result)){
+      costs[(size_t)result[0]] = result[1];
+    }
+    close(fd);
+  }
+  for(pid_t child : workers){ waitpid(child, nullptr, 0); }
+  // Anything a worker didn't get to (fork failed) runs here.
+  for(size_t i = 0; i < candidates.size(); i++){
+    if(isinf(costs[i])){ costs[i] = evaluate(kind, size, candidates[i]); }
+  }
+  return costs;
+}
+
+/**
+ * Pattern-searches one controller's gains.
+ *
+ * @param size Test move size to tune for, 0 for all of them.
+ * @param voltage True to search max voltage too (up to 12).
+ */
+
+static gains tune(controller_kind kind, float size, int rounds, int jobs, bool integral, bool voltage){
+  sim::reset();
+  default_constants();
+  gains best = current_gains(kind);
+  double best_cost = evaluate(kind, size, best);
+  double start_cost = best_cost;
+  float factor = 1.25;
+  float ki_step = fmax(best.ki*0.5f, best.kp*0.02f);
+  float starti_step = fmax(best.starti*0.5f, 2.0f);
+  float voltage_step = 2;
+  char name[32];
+  if(size == 0){ snprintf(name, sizeof(name), "%s", controller_names[kind]); }
+  else { snprintf(name, sizeof(name), "%s %g", controller_names[kind], size); }
+  printf("%-10s start    %9.1f  V %-5.3g kP %-7.4g kI %-7.4g kD %-7.4g startI %-7.4g\n", name, best_cost, best.max_voltage, best.kp, best.ki, best.kd, best.starti);
+
+  for(int round = 1; round <= rounds && factor > 1.01f; round++){
+    std::vector<gains> candidates;
+    // Every combination of a step down, none or a step up on each
+    // of max voltage, kP, kD, kI and startI, as base 3 digits.
+    for(int combination = 0; combination < 243; combination++){
+      int step[5];
+      int rest = combination;
+      for(int &d : step){
+        d = rest%3 - 1;
+        rest /= 3;
+      }
+      if(step[0] == 0 && step[1] == 0 && step[2] == 0 && step[3] == 0 && step[4] == 0){ continue; }
+      if(!voltage && step[0] != 0){ continue; }
+      if(!integral && (step[3] != 0 || step[4] != 0)){ continue; }
+      gains g;
+      g.max_voltage = fmin(12, best.max_voltage + step[0]*voltage_step);
+      g.kp = best.kp*powf(factor, step[1]);
+      g.kd = (best.kd > 0) ? best.kd*powf(factor, step[2]) : fmax(0, step[2]*best.kp);
+      g.ki = fmax(0, best.ki + step[3]*ki_step);
+      g.starti = fmax(0, best.starti + step[4]*starti_step);
+      candidates.push_back(g);
+    }
+    std::vector<double> costs = evaluate_all(kind, size, candidates, jobs);
+    int best_index = -1;
+    for(size_t i = 0; i < candidates.size(); i++){
+      if(costs[i] < best_cost-0.05){
+        best_cost = costs[i];
+        best_index = i;
+      }
+    }
+    if(best_index >= 0){
+      best = candidates[best_index];
+    } else {
+      factor = sqrtf(factor);
+      ki_step *= 0.5f;
+      starti_step *= 0.5f;
+      voltage_step *= 0.5f;
+    }
+    printf("%-10s round %-2d %9.1f  V %-5.3g kP %-7.4g kI %-7.4g kD %-7.4g startI %-7.4g\n", name, round, best_cost, best.max_voltage, best.kp, best.ki, best.kd, best.starti);
+  }
+  printf("%-10s %.1f -> %.1f (%.0f%% better)\n\n", name, start_cost, best_cost, 100*(1-best_cost/start_cost));
+  return best;
+}
+
+// Test move sizes for a kind, smallest first.
+static std::vector<float> move_sizes(controller_kind kind){
+  std::vector<float> sizes;
+  for(const test_move &m : test_moves){
+    float size = fabs(m.target);
+    if(m.kind == kind && std::find(sizes.begin(), sizes.end(), size) == sizes.end()){ sizes.push_back(size); }
+  }
+  std::sort(sizes.begin(), sizes.end());
+  return sizes;
+}
+
+int main(int argc, char **argv){
+  sim::robot_config config;
+  int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int rounds = 20;
+  bool integral = true;
+  bool schedule = false;
+  bool selected[4] = {false, false, false, false};
+  bool any_selected = false;
+  for(int i = 1; i < argc; i++){
+    if(strcmp(argv[i], "--jobs") == 0 && i+1 < argc){ jobs = atoi(argv[++i]); continue; }
+    if(strcmp(argv[i], "--rounds") == 0 && i+1 < argc){ rounds = atoi(argv[++i]); continue; }
+    if(strcmp(argv[i], "--battery") == 0 && i+1 < argc){ config.battery_capacity_pct = atof(argv[++i]); continue; }
+    if(strcmp(argv[i], "--no-integral") == 0){ integral = false; continue; }
+    if(strcmp(argv[i], "--schedule") == 0){ schedule = true; continue; }
+    bool known = false;
+    for(int k = 0; k < 4; k++){
+      if(strcmp(argv[i], controller_names[k]) == 0){ selected[k] = true; known = any_selected = true; }
+    }
+    if(!known){
+      fprintf(stderr, "unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if(!any_selected){
+    for(bool &s : selected){ s = true; }
+  }
+  if(schedule){ selected[HEADING] = false; }
+  sim::configure(config);
+  printf("tuning with %d worker%s, cost is ms plus penalties over the test moves\n\n", jobs, jobs == 1 ? "" : "s");
+
+  auto wall_start = std::chrono::steady_clock::now();
+  if(schedule){
+    std::vector<gains> tuned[4];
+    for(int k = 0; k < 4; k++){
+      if(!selected[k]){ continue; }
+      for(float size : move_sizes((controller_kind)k)){
+        tuned[k].push_back(tune((controller_kind)k, size, rounds, jobs, integral, true));
+      }
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now()-wall_start).count();
+
+    sim::reset();
+    default_constants();
+    const float settle_error[] = {chassis.turn_settle_error, chassis.swing_settle_error, chassis.drive_settle_error, 0};
+    const float settle_time[] = {chassis.turn_settle_time, chassis.swing_settle_time, chassis.drive_settle_time, 0};
+    std::vector<GainPoint> rows[3];
+    for(int k = 0; k < 3; k++){
+      if(!selected[k]){ continue; }
+      std::vector<float> sizes = move_sizes((controller_kind)k);
+      for(size_t i = 0; i < sizes.size(); i++){
+        const gains &g = tuned[k][i];
+        rows[k].push_back({sizes[i], g.max_voltage, g.kp, g.ki, g.kd, g.starti, settle_error[k], settle_time[k]});
+      }
+    }
+    printf("validation, every test move with all the schedules installed together:\n");
+    double default_cost = validate("defaults", nullptr, nullptr);
+    double tuned_cost = validate("schedules", nullptr, rows);
+    printf("%-10s %.1f -> %.1f (%.0f%% better)\n\n", "together", default_cost, tuned_cost, 100*(1-tuned_cost/default_cost));
+
+    const int order[] = {DRIVE, TURN, SWING};
+    printf("// Tuned in the simulator in %.0f s, %.1f -> %.1f together. Paste over the gain schedules in autons.cpp.\n", wall_s, default_cost, tuned_cost);
+    for(int k : order){
+      if(!selected[k]){ continue; }
+      printf("constexpr GainPoint %s_gains[] = {\n", controller_names[k]);
+      printf("  // size, maxVoltage, kP, kI, kD, startI, settle_error, settle_time\n");
+      for(const GainPoint &p : rows[k]){
+        printf("  {%g, %.3g, %.4g, %.4g, %.4g, %.4g, %g, %g},\n", p.size, p.max_voltage, p.kp, p.ki, p.kd, p.starti, p.settle_error, p.settle_time);
+      }
+      printf("};\n");
+    }
+    return 0;
+  }
+
+  gains tuned[4];
+  for(int k = 0; k < 4; k++){
+    sim::reset();
+    default_constants();
+    tuned[k] = current_gains((controller_kind)k);
+    if(selected[k]){ tuned[k] = tune((controller_kind)k, 0, rounds, jobs, integral, false); }
+  }
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now()-wall_start).count();
+
+  printf("validation, every test move with all the tuned gains installed together:\n");
+  double default_cost = validate("defaults", nullptr, nullptr);
+  double tuned_cost = validate("tuned", tuned, nullptr);
+  printf("%-10s %.1f -> %.1f (%.0f%% better)\n\n", "together", default_cost, tuned_cost, 100*(1-tuned_cost/default_cost));
+
+  const char *setters[] = {"set_turn_constants", "set_swing_constants", "set_drive_constants", "set_heading_constants"};
+  const int order[] = {DRIVE, HEADING, TURN, SWING};
+  printf("// Tuned in the simulator in %.0f s, %.1f -> %.1f together. Paste over the constant sets in default_constants().\n", wall_s, default_cost, tuned_cost);
+  printf("  // Each constant set is in the form of (maxVoltage, kP, kI, kD, startI).\n");
+  for(int k : order){
+    printf("  chassis.%s(%.4g, %.4g, %.4g, %.4g, %.4g);\n", setters[k], tuned[k].max_voltage, tuned[k].kp, tuned[k].ki, tuned[k].kd, tuned[k].starti);
+  }
+  return 0;
+}
\ No newline at end of file
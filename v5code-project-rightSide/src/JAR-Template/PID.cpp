@@ -1,14 +1,14 @@
 #include "vex.h"
-#include <iostream>
-using namespace std;
 
-// This constructor remains for basic PID without settling.
+// This constructor remains for basic PID without settling. These
+// steer alongside a settling PID, so their ticks log as auxiliary.
 PID::PID(float error, float kp, float ki, float kd, float starti) :
   error(error),
   kp(kp),
   ki(ki),
   kd(kd),
-  starti(starti)
+  starti(starti),
+  telemetry_source(TELEMETRY_AUX_PID_TICK)
 {};
 
 
@@ -84,37 +84,133 @@ float PID::compute(float error){
 
   time_spent_running += update_period;
 
+  telemetry.log(telemetry_source, consecutive_settled_count > 0 ? SETTLE_IN_BAND : SETTLE_RUNNING, error, output);
+  return output;
+}
+
+/**
+ * Timestamped version of compute(). The derivative and integral use
+ * the measured time since the last call, scaled to update_period so
+ * the same gains work, and the derivative is low-pass filtered by
+ * derivative_filter. Settling and timeout use elapsed time from the
+ * timestamps, so a late loop can't stretch them.
+ * 
+ * @param error Difference in desired and current position.
+ * @param time_us Current time in microseconds, e.g. from vex::timer::systemHighResolution().
+ * @return Output power.
+ */
+
+float PID::compute(float error, uint64_t time_us){
+  uint64_t period_us = update_period*1000;
+  if (!use_timestamps){
+    log_config(time_us);
+    use_timestamps = true;
+    start_time_us = time_us-period_us;
+    previous_time_us = time_us-period_us;
+  }
+  float dt = (time_us-previous_time_us)/1000.0;
+  if (dt <= 0){
+    dt = update_period;
+  }
+  previous_time_us = time_us;
+
+  if (fabs(error) < starti){
+    accumulated_error+=error*dt/update_period;
+  }
+  if ((error>0 && previous_error<0)||(error<0 && previous_error>0)){ 
+    accumulated_error = 0; 
+  }
+
+  float raw_derivative = (error-previous_error)*update_period/dt;
+  derivative = derivative_filter*derivative + (1-derivative_filter)*raw_derivative;
+
+  output = kp*error + ki*accumulated_error + kd*derivative;
+
+  previous_error=error;
+
+  // Settled time counts from the tick that entered the band, the
+  // same as one update_period in compute(float).
+  if(fabs(error) < settle_error){
+    if (!in_settle_band){
+      in_settle_band = true;
+      settled_since_us = time_us-period_us;
+    }
+    time_spent_settled = (time_us-settled_since_us)/1000.0;
+    consecutive_settled_count++;
+  } else {
+    in_settle_band = false;
+    time_spent_settled = 0;
+    consecutive_settled_count = 0;
+  }
+
+  time_spent_running = (time_us-start_time_us)/1000.0;
+
+  telemetry.log(telemetry_source, in_settle_band ? SETTLE_IN_BAND : SETTLE_RUNNING, error, output, time_us);
   return output;
 }
 
 /**
  * Checks if the movement is settled based on the selected mode (flags or time).
- * Timeout is the ultimate failsafe for both modes.
+ * Timeout is the ultimate failsafe for both modes. With settle_velocity
+ * set, stopping inside the settle band for settle_velocity_count ticks
+ * ends the movement in either mode, without waiting out the settle
+ * time. Which one ended the movement goes to telemetry rather than
+ * straight to the console, so the control loop never waits on serial
+ * output.
  * 
  * @return Whether the movement is settled.
  */
 bool PID::is_settled(){
   // 1. Check for timeout first, as it overrides everything.
   if (time_spent_running > timeout && timeout != 0){
-    cout<<"timeout reached"<<endl;
+    settle_reason = SETTLE_TIMEOUT;
+    telemetry.log(TELEMETRY_SETTLED, SETTLE_TIMEOUT, previous_error, output);
     return true;
   }
 
-  // 2. Check settlement based on the mode determined by the constructor.
+  // 2. Stopped inside the band for a few ticks is settled, without
+  // waiting out the settle time.
+  if (settle_velocity > 0 && consecutive_settled_count >= settle_velocity_count && fabs(velocity) < settle_velocity){
+    settle_reason = SETTLE_VELOCITY;
+    telemetry.log(TELEMETRY_SETTLED, SETTLE_VELOCITY, previous_error, velocity);
+    return true;
+  }
+
+  // 3. Check settlement based on the mode determined by the constructor.
   if (use_settle_flags) {
     // Use flag-based settlement
     if (consecutive_settled_count >= settle_flags_requirement) {
-      cout<<"settle_flags reached"<<endl;
+      settle_reason = SETTLE_FLAGS;
+      telemetry.log(TELEMETRY_SETTLED, SETTLE_FLAGS, previous_error, output);
       return true;
     }
   } else {
     // Use time-based settlement
     if (time_spent_settled > settle_time) {
-      cout<<"settle_time reached"<<endl;
+      settle_reason = SETTLE_TIME;
+      telemetry.log(TELEMETRY_SETTLED, SETTLE_TIME, previous_error, output);
       return true;
     }
   }
 
   // If neither timeout nor settlement condition is met, return false.
   return false;
+}
+
+/**
+ * Logs everything that decides this controller's output, so a replay
+ * can rebuild it. Called before the first timestamped tick, once the
+ * motion has set derivative_filter.
+ * 
+ * @param time_us Time of the first tick.
+ */
+
+void PID::log_config(uint64_t time_us){
+  telemetry_type type = (telemetry_source == TELEMETRY_PID_TICK) ? TELEMETRY_PID_CONFIG : TELEMETRY_AUX_PID_CONFIG;
+  telemetry.log(type, 0, kp, ki, time_us);
+  telemetry.log(type, 1, kd, starti, time_us);
+  telemetry.log(type, 2, settle_error, settle_time, time_us);
+  telemetry.log(type, 3, timeout, update_period, time_us);
+  telemetry.log(type, 4, derivative_filter, use_settle_flags ? settle_flags_requirement : 0, time_us);
+  telemetry.log(type, 5, settle_velocity, settle_velocity_count, time_us);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "vex.h"
+
+AutonProfiler profiler;
+
+// Room for the header and every step, so save() can write the CSV in
+// one go.
+static char csv[128*(AutonProfiler::max_steps+1)];
+
+AutonProfiler::AutonProfiler(){};
+
+/**
+ * Clears the steps and starts timing an auton. Call it right before
+ * the auton runs.
+ */
+
+void AutonProfiler::start(){
+  step_count = 0;
+  dropped = 0;
+  start_time = vex::timer::system();
+  running = true;
+}
+
+/**
+ * Records the start of a step. Does nothing unless an auton is being
+ * profiled.
+ * 
+ * @param name Step name, which has to outlive the report, like a string literal.
+ * @param motion_id Drive motion id, or 0 for anything else.
+ * @param start_error Error at the start, in inches or degrees.
+ * @return Step index to pass to end(), or -1 if it wasn't recorded.
+ */
+
+int AutonProfiler::begin(const char *name, int motion_id, float start_error){
+  if (!running){
+    return(-1);
+  }
+  if (step_count >= max_steps){
+    dropped++;
+    return(-1);
+  }
+  AutonStep &step = steps[step_count];
+  step.name = name;
+  step.motion_id = motion_id;
+  step.start_ms = vex::timer::system()-start_time;
+  step.end_ms = step.start_ms;
+  step.exit_reason = SETTLE_RUNNING;
+  step.settle_count = 0;
+  step.start_error = start_error;
+  step.final_error = start_error;
+  step.peak_voltage = 0;
+  return(step_count++);
+}
+
+/**
+ * Records the end of a step.
+ * 
+ * @param step Index from begin(), ignored if -1.
+ * @param exit_reason Why it ended, as a settle_state.
+ * @param settle_count Consecutive ticks it had been inside its settle error.
+ * @param final_error Error at the end.
+ * @param peak_voltage Highest voltage it commanded.
+ */
+
+void AutonProfiler::end(int step, uint8_t exit_reason, int settle_count, float final_error, float peak_voltage){
+  if (!running || step < 0 || step >= step_count){
+    return;
+  }
+  AutonStep &s = steps[step];
+  s.end_ms = vex::timer::system()-start_time;
+  s.exit_reason = exit_reason;
+  s.settle_count = settle_count;
+  s.final_error = final_error;
+  s.peak_voltage = peak_voltage;
+}
+
+/**
+ * Short name for an exit reason.
+ * 
+ * @param exit_reason A settle_state.
+ * @return Its name.
+ */
+
+const char *AutonProfiler::exit_name(uint8_t exit_reason){
+  switch(exit_reason){
+    case SETTLE_IN_BAND: return("in_band");
+    case SETTLE_TIMEOUT: return("timeout");
+    case SETTLE_TIME: return("settle_time");
+    case SETTLE_FLAGS: return("settle_flags");
+    case SETTLE_VELOCITY: return("settle_velocity");
+  }
+  return("cancelled");
+}
+
+/**
+ * Stops profiling and prints the table, then saves it to the SD card
+ * if one is in. Does nothing if no auton is being profiled, so it's
+ * safe to call again, for example from usercontrol in case the auton
+ * period ended before the auton did.
+ */
+
+void AutonProfiler::report(){
+  if (!running){
+    return;
+  }
+  running = false;
+  uint32_t total_ms = vex::timer::system()-start_time;
+  uint32_t motion_ms = 0;
+  uint32_t timeout_ms = 0;
+  int timeouts = 0;
+  uint32_t previous_end = 0;
+  printf("auton profile: %d steps in %lu ms\n", step_count, (unsigned long)total_ms);
+  printf("   #  start    end   time  step                   exit             start_err final_err peak_V\n");
+  for(int i = 0; i < step_count; i++){
+    const AutonStep &s = steps[i];
+    if (s.start_ms > previous_end){
+      printf("      %5lu  %5lu  %5lu  (between steps)\n", (unsigned long)previous_end, (unsigned long)s.start_ms, (unsigned long)(s.start_ms-previous_end));
+    }
+    uint32_t time_ms = s.end_ms-s.start_ms;
+    printf("  %2d  %5lu  %5lu  %5lu  %-22s %-16s %9.2f %9.2f %6.2f\n", i+1, (unsigned long)s.start_ms, (unsigned long)s.end_ms,
+      (unsigned long)time_ms, s.name, exit_name(s.exit_reason), s.start_error, s.final_error, s.peak_voltage);
+    motion_ms += time_ms;
+    if (s.exit_reason == SETTLE_TIMEOUT){
+      timeouts++;
+      timeout_ms += time_ms;
+    }
+    if (s.end_ms > previous_end){
+      previous_end = s.end_ms;
+    }
+  }
+  if (total_ms > previous_end){
+    printf("      %5lu  %5lu  %5lu  (after last step)\n", (unsigned long)previous_end, (unsigned long)total_ms, (unsigned long)(total_ms-previous_end));
+  }
+  printf("steps %lu ms, between and after steps %lu ms, %d timed out using %lu ms", (unsigned long)motion_ms,
+    (unsigned long)(total_ms > motion_ms ? total_ms-motion_ms : 0), timeouts, (unsigned long)timeout_ms);
+  if (dropped > 0){
+    printf(", %d steps not recorded", dropped);
+  }
+  printf("\n");
+  save();
+}
+
+/**
+ * Saves the steps to filename on the SD card as CSV, one row per step.
+ * The whole file is formatted in memory first and written with one
+ * savefile(), since each SD card call blocks the calling task.
+ */
+
+void AutonProfiler::save(){
+  if (!Brain.SDcard.isInserted()){
+    return;
+  }
+  int length = snprintf(csv, sizeof(csv), "step,name,motion_id,start_ms,end_ms,time_ms,exit,settle_count,start_error,final_error,peak_voltage\n");
+  for(int i = 0; i < step_count && length < (int)sizeof(csv); i++){
+    const AutonStep &s = steps[i];
+    length += snprintf(csv+length, sizeof(csv)-length, "%d,%s,%d,%lu,%lu,%lu,%s,%d,%.3f,%.3f,%.2f\n", i+1, s.name, s.motion_id,
+      (unsigned long)s.start_ms, (unsigned long)s.end_ms, (unsigned long)(s.end_ms-s.start_ms), exit_name(s.exit_reason),
+      s.settle_count, s.start_error, s.final_error, s.peak_voltage);
+  }
+  if (length > (int)sizeof(csv)-1){
+    length = sizeof(csv)-1;
+  }
+  Brain.SDcard.savefile(filename, (uint8_t*)csv, length);
+}
@@ -0,0 +1,147 @@
+#include "vex.h"
+
+AutonSelector selector(auton_registry, auton_count);
+
+/**
+ * Selector over a registry of autons, starting on the first one.
+ * 
+ * @param autons The registry, which has to outlive the selector.
+ * @param auton_count Number of entries in the registry.
+ */
+
+AutonSelector::AutonSelector(const AutonEntry *autons, int auton_count) :
+  autons(autons),
+  auton_count(auton_count)
+{};
+
+/**
+ * Selects an auton by index, wrapping around either end of the
+ * registry, and saves the choice.
+ * 
+ * @param index Registry index.
+ */
+
+void AutonSelector::select(int index){
+  if (auton_count <= 0){
+    return;
+  }
+  index %= auton_count;
+  if (index < 0){
+    index += auton_count;
+  }
+  selection = index;
+  save();
+}
+
+/**
+ * Selects an auton by name.
+ * 
+ * @param name Name in the registry.
+ * @return True if the name was found.
+ */
+
+bool AutonSelector::select(const char *name){
+  for(int i = 0; i < auton_count; i++){
+    if (strcmp(autons[i].name, name) == 0){
+      select(i);
+      return(true);
+    }
+  }
+  return(false);
+}
+
+const char *AutonSelector::selected_name(){
+  if (auton_count <= 0){
+    return("none");
+  }
+  return(autons[selection].name);
+}
+
+/**
+ * Restores the auton saved by the last selection, if the SD card has
+ * one and it's still in the registry.
+ */
+
+void AutonSelector::load(){
+  if (!Brain.SDcard.isInserted()){
+    return;
+  }
+  char name[field_length] = {};
+  int32_t length = Brain.SDcard.loadfile(filename, (uint8_t*)name, sizeof(name)-1);
+  if (length <= 0){
+    return;
+  }
+  name[length] = 0;
+  name[strcspn(name, "\r\n")] = 0;
+  for(int i = 0; i < auton_count; i++){
+    if (strcmp(autons[i].name, name) == 0){
+      selection = i;
+    }
+  }
+}
+
+/**
+ * Saves the selected auton's name to the SD card, so a reordered
+ * registry still restores the same auton.
+ */
+
+void AutonSelector::save(){
+  if (!Brain.SDcard.isInserted()){
+    return;
+  }
+  const char *name = selected_name();
+  Brain.SDcard.savefile(filename, (uint8_t*)name, strlen(name));
+}
+
+/**
+ * Draws the pre-auton screen. The labels are drawn once and after that
+ * each field is repainted only when its text changes, padded so the
+ * new text covers the old.
+ */
+
+void AutonSelector::draw(){
+  if (!screen_drawn){
+    Brain.Screen.clearScreen();
+    Brain.Screen.printAt(5, 20, "JAR Template v1.2.0");
+    Brain.Screen.printAt(5, 40, "Battery Percentage:");
+    Brain.Screen.printAt(5, 80, "Chassis Heading Reading:");
+    Brain.Screen.printAt(5, 120, "Selected Auton:");
+    Brain.Screen.printAt(5, 180, "< tap left          tap right >");
+    screen_drawn = true;
+  }
+  char text[field_count][field_length];
+  snprintf(text[0], field_length, "%lu", (unsigned long)Brain.Battery.capacity());
+  snprintf(text[1], field_length, "%.1f", chassis.get_absolute_heading());
+  snprintf(text[2], field_length, "%d/%d %s", selection+1, auton_count, selected_name());
+  const int y[field_count] = {60, 100, 140};
+  for(int i = 0; i < field_count; i++){
+    if (strcmp(text[i], drawn[i]) != 0){
+      Brain.Screen.printAt(5, y[i], "%-*s", field_length-1, text[i]);
+      strcpy(drawn[i], text[i]);
+    }
+  }
+}
+
+/**
+ * Runs the selected auton.
+ */
+
+void AutonSelector::run(){
+  if (auton_count <= 0){
+    return;
+  }
+  autons[selection].run();
+}
+
+/**
+ * Brain screen touch callback. Register it with
+ * Brain.Screen.pressed(AutonSelector::screen_pressed).
+ */
+
+void AutonSelector::screen_pressed(){
+  if (Brain.Screen.xPosition() < 240){
+    selector.select(selector.selection-1);
+  } else {
+    selector.select(selector.selection+1);
+  }
+}
@@ -0,0 +1,73 @@
+#include "vex.h"
+
+BatteryCompensation battery;
+
+BatteryCompensation::BatteryCompensation(){};
+
+/**
+ * Sets the bus voltage that commands are relative to, which should be
+ * what the battery reads at full charge. Compensation starts once the
+ * battery drops below it.
+ * 
+ * @param nominal_voltage Full-charge battery voltage in volts.
+ */
+
+void BatteryCompensation::set_nominal_voltage(float nominal_voltage){
+  this->nominal_voltage = nominal_voltage;
+}
+
+/**
+ * Gets the filtered battery voltage, reading the battery again if a
+ * sample period has passed. The first read, or one after the clock
+ * goes backwards, starts the filter over.
+ * 
+ * @return Filtered battery voltage in volts.
+ */
+
+float BatteryCompensation::voltage(){
+  uint32_t now = vex::timer::system();
+  if (filtered_voltage <= 0 || now < last_sample_time){
+    filtered_voltage = Brain.Battery.voltage();
+    last_sample_time = now;
+  } else if (now-last_sample_time >= sample_period){
+    float elapsed = now-last_sample_time;
+    float weight = 1-exp(-elapsed/filter_time_constant);
+    filtered_voltage += weight*(Brain.Battery.voltage()-filtered_voltage);
+    last_sample_time = now;
+  }
+  return(filtered_voltage);
+}
+
+/**
+ * Converts a command in nominal volts to the voltage to send now. At
+ * or above the nominal voltage it's sent as is.
+ * 
+ * @param command Voltage out of 12 at the nominal bus voltage.
+ * @return Voltage out of 12 to send to the motor.
+ */
+
+float BatteryCompensation::compensate(float command){
+  if (!enabled){
+    return(command);
+  }
+  float bus_voltage = voltage();
+  if (bus_voltage <= 0 || bus_voltage >= nominal_voltage){
+    return(command);
+  }
+  return(clamp(command*nominal_voltage/bus_voltage, -12, 12));
+}
+
+/**
+ * Gets the largest command, in nominal volts, the battery can deliver
+ * in full right now. It's 12 until the battery drops below the nominal
+ * voltage.
+ * 
+ * @return Largest deliverable command in volts.
+ */
+
+float BatteryCompensation::headroom(){
+  if (!enabled){
+    return(12);
+  }
+  return(12*fmin(1, voltage()/nominal_voltage));
+}
@@ -66,19 +66,23 @@ int SidewaysTracker_port, float SidewaysTracker_diameter, float SidewaysTracker_
 
 /**
  * Drives each side of the chassis at the specified voltage.
+ * Voltages are battery compensated, so they're out of 12 at the
+ * nominal battery voltage rather than whatever the battery has now.
  * 
  * @param leftVoltage Voltage out of 12.
  * @param rightVoltage Voltage out of 12.
  */
 
 void Drive::drive_with_voltage(float leftVoltage, float rightVoltage){
-  DriveL.spin(fwd, leftVoltage, volt);
-  DriveR.spin(fwd, rightVoltage,volt);
+  motion.peak_voltage = fmax(motion.peak_voltage, fmax(fabs(leftVoltage), fabs(rightVoltage)));
+  DriveL.spin(fwd, battery.compensate(leftVoltage*derating), volt);
+  DriveR.spin(fwd, battery.compensate(rightVoltage*derating), volt);
 }
 
 /**
  * Resets default turn constants.
  * Turning includes turn_to_angle() and turn_to_point().
+ * Also turns off any turn schedule, so these are what get used.
  * 
  * @param turn_max_voltage Max voltage out of 12.
  * @param turn_kp Proportional constant.
@@ -93,12 +97,13 @@ void Drive::set_turn_constants(float turn_max_voltage, float turn_kp, float turn
   this->turn_ki = turn_ki;
   this->turn_kd = turn_kd;
   this->turn_starti = turn_starti;
+  this->turn_schedule = nullptr;
 } 
 
 /**
  * Resets default drive constants.
  * Driving includes drive_distance(), drive_to_point(), and
- * holonomic_drive_to_point().
+ * holonomic_drive_to_point(). Also turns off any drive schedule.
  * 
  * @param drive_max_voltage Max voltage out of 12.
  * @param drive_kp Proportional constant.
@@ -113,6 +118,7 @@ void Drive::set_drive_constants(float drive_max_voltage, float drive_kp, float d
   this->drive_ki = drive_ki;
   this->drive_kd = drive_kd;
   this->drive_starti = drive_starti;
+  this->drive_schedule = nullptr;
 } 
 
 /**
@@ -140,6 +146,7 @@ void Drive::set_heading_constants(float heading_max_voltage, float heading_kp, f
  * Resets default swing constants.
  * Swing control holds one side of the drive still and turns with the other.
  * Only left_swing_to_angle() and right_swing_to_angle() use these constants.
+ * Also turns off any swing schedule.
  * 
  * @param swing_max_voltage Max voltage out of 12.
  * @param swing_kp Proportional constant.
@@ -154,6 +161,7 @@ void Drive::set_swing_constants(float swing_max_voltage, float swing_kp, float s
   this->swing_ki = swing_ki;
   this->swing_kd = swing_kd;
   this->swing_starti = swing_starti;
+  this->swing_schedule = nullptr;
 } 
 
 /**
@@ -204,6 +212,236 @@ void Drive::set_swing_exit_conditions(float swing_settle_error, float swing_sett
   this->swing_timeout = swing_timeout;
 }
 
+/**
+ * Sets how slow the robot must be going to count as stopped. Once a
+ * motion is inside its settle error and slower than this, it ends
+ * right away instead of waiting out the settle time, which stays as
+ * the fallback for a robot that creeps. Drives use the drive motors'
+ * speed, turns and swings the gyro's turn rate. 0 turns it off.
+ * 
+ * @param drive_settle_velocity Stopped speed for drives in inches per second.
+ * @param turn_settle_velocity Stopped turn rate for turns in degrees per second.
+ * @param swing_settle_velocity Stopped turn rate for swings in degrees per second.
+ */
+
+void Drive::set_settle_velocities(float drive_settle_velocity, float turn_settle_velocity, float swing_settle_velocity){
+  this->drive_settle_velocity = drive_settle_velocity;
+  this->turn_settle_velocity = turn_settle_velocity;
+  this->swing_settle_velocity = swing_settle_velocity;
+}
+
+/**
+ * Scales down the drive's voltage to keep hot motors out of their
+ * thermal current limit. Auton motions, swings and tank and arcade
+ * driver control all apply it. Both sides get the same fraction, so
+ * derating never turns a straight drive into a curve. A motor health
+ * monitor is expected to keep it up to date; 1 is full power.
+ * 
+ * @param derating Fraction of the drive's voltage to use.
+ */
+
+void Drive::set_derating(float derating){
+  this->derating = derating;
+}
+
+/**
+ * Sets the motion profile limits for profiled drives.
+ * 
+ * @param drive_max_velocity Cruise speed in inches per second.
+ * @param drive_max_acceleration Acceleration limit in inches per second squared.
+ */
+
+void Drive::set_drive_profile(float drive_max_velocity, float drive_max_acceleration){
+  this->drive_max_velocity = drive_max_velocity;
+  this->drive_max_acceleration = drive_max_acceleration;
+}
+
+/**
+ * The original form, from before set_drive_feedforward(). It still
+ * sets the feedforward's kV and kA, keeping kS, so existing calls
+ * behave the same.
+ * 
+ * @param drive_kv Volts per inch per second.
+ * @param drive_ka Volts per inch per second squared.
+ */
+
+void Drive::set_drive_profile(float drive_max_velocity, float drive_max_acceleration, float drive_kv, float drive_ka){
+  set_drive_profile(drive_max_velocity, drive_max_acceleration);
+  drive_feedforward.kV = drive_kv;
+  drive_feedforward.kA = drive_ka;
+}
+
+/**
+ * Sets the motion profile limits for profiled turns.
+ * 
+ * @param turn_max_velocity Cruise speed in degrees per second.
+ * @param turn_max_acceleration Acceleration limit in degrees per second squared.
+ */
+
+void Drive::set_turn_profile(float turn_max_velocity, float turn_max_acceleration){
+  this->turn_max_velocity = turn_max_velocity;
+  this->turn_max_acceleration = turn_max_acceleration;
+}
+
+/**
+ * The original form, from before set_turn_feedforward(). It still
+ * sets the feedforward's kV and kA, keeping kS, so existing calls
+ * behave the same.
+ * 
+ * @param turn_kv Volts per degree per second.
+ * @param turn_ka Volts per degree per second squared.
+ */
+
+void Drive::set_turn_profile(float turn_max_velocity, float turn_max_acceleration, float turn_kv, float turn_ka){
+  set_turn_profile(turn_max_velocity, turn_max_acceleration);
+  turn_feedforward.kV = turn_kv;
+  turn_feedforward.kA = turn_ka;
+}
+
+/**
+ * Sets the feedforward for straight-line motion. characterize_drive()
+ * measures these and prints them in this form.
+ * 
+ * @param kS Volts to start the robot moving.
+ * @param kV Volts per inch per second.
+ * @param kA Volts per inch per second squared.
+ */
+
+void Drive::set_drive_feedforward(float kS, float kV, float kA){
+  drive_feedforward = Feedforward(kS, kV, kA);
+}
+
+/**
+ * Sets the feedforward for turning in place, applied as opposite
+ * voltages on the two sides. characterize_turn() measures these.
+ * 
+ * @param kS Volts to start the robot turning.
+ * @param kV Volts per degree per second.
+ * @param kA Volts per degree per second squared.
+ */
+
+void Drive::set_turn_feedforward(float kS, float kV, float kA){
+  turn_feedforward = Feedforward(kS, kV, kA);
+}
+
+/**
+ * Sets gain schedules, which replace the fixed constants for moves
+ * of different sizes. The motion overloads take whatever they aren't
+ * given from the schedule: drive_distance(24) gets everything from
+ * it, while drive_distance(24, 90, 8, 6, 1, 300, 1000) keeps its own
+ * voltages and exit conditions and only gets kP, kI, kD and startI.
+ * The overloads that take gains ignore the schedule. The drive
+ * schedule covers drive_distance(), turn covers turn_to_angle(), and
+ * swing covers both swings. Timeouts always come from the exit
+ * conditions. nullptr goes back to the fixed constants, and so does
+ * calling the matching set_*_constants() afterwards.
+ * 
+ * @param drive_schedule Schedule keyed by distance in inches.
+ */
+
+void Drive::set_drive_schedule(const GainSchedule *drive_schedule){
+  this->drive_schedule = drive_schedule;
+}
+
+void Drive::set_turn_schedule(const GainSchedule *turn_schedule){
+  this->turn_schedule = turn_schedule;
+}
+
+void Drive::set_swing_schedule(const GainSchedule *swing_schedule){
+  this->swing_schedule = swing_schedule;
+}
+
+/**
+ * Sets the response curves driver control shapes the sticks with.
+ * Tank uses the throttle curve for both sticks, and holonomic uses it
+ * for strafe too. nullptr goes back to a plain deadband of 5.
+ * 
+ * @param throttle_curve Curve for throttle, which has to outlive the chassis.
+ * @param turn_curve Curve for turning.
+ */
+
+void Drive::set_joystick_curves(const JoystickCurve *throttle_curve, const JoystickCurve *turn_curve){
+  this->throttle_curve = throttle_curve;
+  this->turn_curve = turn_curve;
+}
+
+/**
+ * Gets the constants for a drive of a given distance, from the drive
+ * schedule at the current speed if there is one, or the fixed drive
+ * constants if not. Speed is counted against the drive profile's
+ * acceleration.
+ * 
+ * @param distance Desired distance in inches.
+ * @return Constants for the move.
+ */
+
+GainPoint Drive::drive_gains(float distance){
+  if (drive_schedule == nullptr){
+    return {fabsf(distance), drive_max_voltage, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time};
+  }
+  sample_sensors();
+  return(drive_schedule->lookup(distance, sensors.forward_velocity, drive_max_acceleration));
+}
+
+/**
+ * Gets the constants for a turn to a field-centric angle, from the
+ * turn schedule at the current turn rate if there is one.
+ * 
+ * @param angle Desired angle in degrees.
+ * @return Constants for the move.
+ */
+
+GainPoint Drive::turn_gains(float angle){
+  float turn_angle = reduce_negative_180_to_180(angle - get_absolute_heading());
+  if (turn_schedule == nullptr){
+    return {fabsf(turn_angle), turn_max_voltage, turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time};
+  }
+  sample_gyro();
+  return(turn_schedule->lookup(turn_angle, sensors.turn_velocity, turn_max_acceleration));
+}
+
+/**
+ * Gets the constants for a swing to a field-centric angle, from the
+ * swing schedule at the current turn rate if there is one.
+ * 
+ * @param angle Desired angle in degrees.
+ * @return Constants for the move.
+ */
+
+GainPoint Drive::swing_gains(float angle){
+  float swing_angle = reduce_negative_180_to_180(angle - get_absolute_heading());
+  if (swing_schedule == nullptr){
+    return {fabsf(swing_angle), swing_max_voltage, swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time};
+  }
+  sample_gyro();
+  return(swing_schedule->lookup(swing_angle, sensors.turn_velocity, turn_max_acceleration));
+}
+
+/**
+ * Sets the period of every motion's control loop.
+ * Loops run on absolute deadlines, so this is the true period rather
+ * than a sleep added on top of compute time. PIDs created by the
+ * motions use it as their update period for settling and timeouts.
+ * 
+ * @param loop_period Loop period in milliseconds, 10 for 100Hz or 5 for 200Hz.
+ */
+
+void Drive::set_loop_period(float loop_period){
+  control_loop.period = loop_period;
+}
+
+/**
+ * Sets the derivative low-pass filter used by every motion's PIDs.
+ * Each tick keeps this fraction of the previous derivative, so higher
+ * values smooth out sensor noise at the cost of some lag.
+ * 
+ * @param derivative_filter Filter weight in [0, 1), 0 for no filtering.
+ */
+
+void Drive::set_derivative_filter(float derivative_filter){
+  this->derivative_filter = derivative_filter;
+}
+
 /**
  * Gives the drive's absolute heading with Gyro correction.
  * 
@@ -214,6 +452,42 @@ float Drive::get_absolute_heading(){
   return( reduce_0_to_360( Gyro.rotation()*360.0/gyro_scale ) ); 
 }
 
+/**
+ * Reads every drive sensor once and stores the results, with the time
+ * they were read, in sensors. Motion loops call this at the top of
+ * each tick and use only the snapshot for the rest of it, so one tick
+ * reads each sensor once (position and speed from each motor group,
+ * angle and rate from the gyro), and every calculation in it sees
+ * the same robot state. The odom pose comes from one published tuple,
+ * so X and Y are always from the same odom update, and pose_time_us
+ * says when that was.
+ */
+
+void Drive::sample_sensors(){
+  sample_gyro();
+  sensors.left_position_in = get_left_position_in();
+  sensors.right_position_in = get_right_position_in();
+  sensors.forward_velocity = (DriveL.velocity(rpm)+DriveR.velocity(rpm))/2.0*6.0*drive_in_to_deg_ratio;
+  OdomPose pose = odom.get_pose();
+  sensors.X_position = pose.X_position;
+  sensors.Y_position = pose.Y_position;
+  sensors.pose_time_us = pose.time_us;
+}
+
+/**
+ * Reads just the gyro into sensors: time, rotation, heading and turn
+ * rate. Turns and swings only steer by the gyro, so they call this
+ * instead of sample_sensors() and skip the motor group and pose
+ * reads. The other fields keep whatever they last held.
+ */
+
+void Drive::sample_gyro(){
+  sensors.time_us = vex::timer::systemHighResolution();
+  sensors.rotation = Gyro.rotation()*360.0/gyro_scale;
+  sensors.heading = reduce_0_to_360(sensors.rotation);
+  sensors.turn_velocity = Gyro.gyroRate(zaxis, dps)*360.0/gyro_scale;
+}
+
 /**
  * Gets the motor group's position and converts to inches.
  * 
@@ -254,42 +528,38 @@ void Drive::drive_stop(vex::brakeType mode){
  */
 
 void Drive::turn_to_angle(float angle){
-  turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
+  GainPoint gains = turn_gains(angle);
+  turn_to_angle(angle, gains.max_voltage, gains.settle_error, gains.settle_time, turn_timeout, gains.kp, gains.ki, gains.kd, gains.starti);
 }
 
 void Drive::turn_to_angle(float angle, float turn_max_voltage){
-  turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
-}
-
-void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout){
-  turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
-}
-
-void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, int turn_settle_flags, float turn_timeout){
-  turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_flags, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
+  GainPoint gains = turn_gains(angle);
+  turn_to_angle(angle, turn_max_voltage, gains.settle_error, gains.settle_time, turn_timeout, gains.kp, gains.ki, gains.kd, gains.starti);
 }
 
-void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti){
-  PID turnPID(reduce_negative_180_to_180(angle - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time, turn_timeout);
-  while( !turnPID.is_settled() ){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = turnPID.compute(error);
-    output = clamp(output, -turn_max_voltage, turn_max_voltage);
-    drive_with_voltage(output, -output);
-    task::sleep(10);
-  }
-  chassis.drive_stop(hold);
+void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags){
+  GainPoint gains = turn_gains(angle);
+  turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, gains.kp, gains.ki, gains.kd, gains.starti, settle_flags);
 }
 
-void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, int turn_settle_flags, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti){
-  PID turnPID(reduce_negative_180_to_180(angle - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_flags, turn_timeout);
+void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti, int settle_flags){
+  PID turnPID(reduce_negative_180_to_180(angle - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time, turn_timeout, control_loop.period, settle_flags);
+  turnPID.derivative_filter = derivative_filter;
+  turnPID.settle_velocity = turn_settle_velocity;
+  begin_motion("turn_to_angle", turnPID.error);
+  control_loop.start();
   while( !turnPID.is_settled() ){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = turnPID.compute(error);
+    if(motion.cancelled){ break; }
+    sample_gyro();
+    turnPID.velocity = sensors.turn_velocity;
+    float error = reduce_negative_180_to_180(angle - sensors.heading);
+    motion.error = error;
+    float output = turnPID.compute(error, sensors.time_us);
     output = clamp(output, -turn_max_voltage, turn_max_voltage);
     drive_with_voltage(output, -output);
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(turnPID);
   chassis.drive_stop(hold);
 }
 
@@ -306,69 +576,263 @@ void Drive::turn_to_angle(float angle, float turn_max_voltage, float turn_settle
  */
 
 void Drive::drive_distance(float distance){
-  drive_distance(distance, get_absolute_heading(), drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+  GainPoint gains = drive_gains(distance);
+  drive_distance(distance, get_absolute_heading(), gains.max_voltage, heading_max_voltage, gains.settle_error, gains.settle_time, drive_timeout, gains.kp, gains.ki, gains.kd, gains.starti, heading_kp, heading_ki, heading_kd, heading_starti);
 }
 
 void Drive::drive_distance(float distance, float heading){
-  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+  GainPoint gains = drive_gains(distance);
+  drive_distance(distance, heading, gains.max_voltage, heading_max_voltage, gains.settle_error, gains.settle_time, drive_timeout, gains.kp, gains.ki, gains.kd, gains.starti, heading_kp, heading_ki, heading_kd, heading_starti);
 }
 
 void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage){
-  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
-}
-
-void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout){
-  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+  GainPoint gains = drive_gains(distance);
+  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, gains.settle_error, gains.settle_time, drive_timeout, gains.kp, gains.ki, gains.kd, gains.starti, heading_kp, heading_ki, heading_kd, heading_starti);
 }
 
-void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout){
-  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_flags, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags){
+  GainPoint gains = drive_gains(distance);
+  drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, gains.kp, gains.ki, gains.kd, gains.starti, heading_kp, heading_ki, heading_kd, heading_starti, settle_flags);
 }
 
-void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout);
+void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags){
+  PID drivePID(distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout, control_loop.period, settle_flags);
+  drivePID.derivative_filter = derivative_filter;
+  drivePID.settle_velocity = drive_settle_velocity;
   PID headingPID(reduce_negative_180_to_180(heading - get_absolute_heading()), heading_kp, heading_ki, heading_kd, heading_starti);
+  headingPID.derivative_filter = derivative_filter;
   float start_average_position = (get_left_position_in()+get_right_position_in())/2.0;
   float average_position = start_average_position;
 
+  begin_motion("drive_distance", distance);
+  control_loop.start();
   while(drivePID.is_settled() == false){
-    average_position = (get_left_position_in()+get_right_position_in())/2.0;
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    drivePID.velocity = sensors.forward_velocity;
+    average_position = (sensors.left_position_in+sensors.right_position_in)/2.0;
     float drive_error = distance+start_average_position-average_position;
-    float heading_error = reduce_negative_180_to_180(heading - get_absolute_heading());
-    float drive_output = drivePID.compute(drive_error);
-    float heading_output = headingPID.compute(heading_error);
+    motion.error = drive_error;
+    float heading_error = reduce_negative_180_to_180(heading - sensors.heading);
+    float drive_output = drivePID.compute(drive_error, sensors.time_us);
+    float heading_output = headingPID.compute(heading_error, sensors.time_us);
 
     drive_output = clamp(drive_output, -drive_max_voltage, drive_max_voltage);
     heading_output = clamp(heading_output, -heading_max_voltage, heading_max_voltage);
 
     drive_with_voltage(drive_output+heading_output, drive_output-heading_output);
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(drivePID);
   drive_stop(hold);
 }
 
-void Drive::drive_distance(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_flags, drive_timeout);
+
+/**
+ * Drives a given distance along a motion profile.
+ * Instead of running PID on the whole distance with a voltage cap,
+ * each tick takes a position and velocity setpoint from an
+ * acceleration-limited profile. Feedforward supplies the voltage
+ * for that velocity, and the drive PID only corrects the small
+ * tracking error. Long moves can then use the full 12 volts and
+ * still stop without overshoot. Settling only counts once the
+ * profile has finished; the timeout applies throughout.
+ * 
+ * @param distance Desired distance in inches.
+ * @param heading Desired heading in degrees.
+ */
+
+void Drive::drive_distance_profiled(float distance){
+  drive_distance_profiled(distance, get_absolute_heading(), drive_settle_error, drive_settle_time, drive_timeout);
+}
+
+void Drive::drive_distance_profiled(float distance, float heading){
+  drive_distance_profiled(distance, heading, drive_settle_error, drive_settle_time, drive_timeout);
+}
+
+void Drive::drive_distance_profiled(float distance, float heading, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags){
+  // Cruise no faster than the battery can hold while still accelerating.
+  float max_velocity = fmin(drive_max_velocity, drive_feedforward.max_velocity(battery.headroom(), drive_max_acceleration));
+  MotionProfile profile(distance, max_velocity, drive_max_acceleration, profile_s_curve);
+  PID drivePID(0, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout, control_loop.period, settle_flags);
+  drivePID.derivative_filter = derivative_filter;
+  drivePID.settle_velocity = drive_settle_velocity;
   PID headingPID(reduce_negative_180_to_180(heading - get_absolute_heading()), heading_kp, heading_ki, heading_kd, heading_starti);
+  headingPID.derivative_filter = derivative_filter;
   float start_average_position = (get_left_position_in()+get_right_position_in())/2.0;
-  float average_position = start_average_position;
 
+  begin_motion("drive_distance_profiled", distance);
+  control_loop.start();
   while(drivePID.is_settled() == false){
-    average_position = (get_left_position_in()+get_right_position_in())/2.0;
-    float drive_error = distance+start_average_position-average_position;
-    float heading_error = reduce_negative_180_to_180(heading - get_absolute_heading());
-    float drive_output = drivePID.compute(drive_error);
-    float heading_output = headingPID.compute(heading_error);
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    drivePID.velocity = sensors.forward_velocity;
+    float time = control_loop.elapsed_ms()/1000.0;
+    profile.sample(time);
+    float traveled = (sensors.left_position_in+sensors.right_position_in)/2.0-start_average_position;
+    motion.error = distance-traveled;
+    float drive_error = profile.position-traveled;
+    float heading_error = reduce_negative_180_to_180(heading - sensors.heading);
+    float drive_output = drive_feedforward.calculate(profile.velocity, profile.acceleration) + drivePID.compute(drive_error, sensors.time_us);
+    float heading_output = headingPID.compute(heading_error, sensors.time_us);
+    if (time < profile.duration){
+      drivePID.time_spent_settled = 0;
+      drivePID.consecutive_settled_count = 0;
+      drivePID.in_settle_band = false;
+    }
 
-    drive_output = clamp(drive_output, -drive_max_voltage, drive_max_voltage);
+    drive_output = clamp(drive_output, -12, 12);
     heading_output = clamp(heading_output, -heading_max_voltage, heading_max_voltage);
 
-    drive_with_voltage(drive_output+heading_output, drive_output-heading_output);
-    task::sleep(10);
+    drive_with_voltage(left_voltage_scaling(drive_output, heading_output), right_voltage_scaling(drive_output, heading_output));
+    control_loop.wait();
   }
+  end_motion(drivePID);
   drive_stop(hold);
 }
 
+/**
+ * Turns to a field-centric angle along a motion profile.
+ * Works like drive_distance_profiled(), with the turn PID tracking
+ * a heading setpoint. Turns whichever way is shorter.
+ * 
+ * @param angle Desired angle in degrees.
+ */
+
+void Drive::turn_to_angle_profiled(float angle){
+  turn_to_angle_profiled(angle, turn_settle_error, turn_settle_time, turn_timeout);
+}
+
+void Drive::turn_to_angle_profiled(float angle, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags){
+  float start_heading = get_absolute_heading();
+  float turn_distance = reduce_negative_180_to_180(angle - start_heading);
+  float max_velocity = fmin(turn_max_velocity, turn_feedforward.max_velocity(battery.headroom(), turn_max_acceleration));
+  MotionProfile profile(turn_distance, max_velocity, turn_max_acceleration, profile_s_curve);
+  PID turnPID(0, turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time, turn_timeout, control_loop.period, settle_flags);
+  turnPID.derivative_filter = derivative_filter;
+  turnPID.settle_velocity = turn_settle_velocity;
+
+  begin_motion("turn_to_angle_profiled", turn_distance);
+  control_loop.start();
+  while( !turnPID.is_settled() ){
+    if(motion.cancelled){ break; }
+    sample_gyro();
+    turnPID.velocity = sensors.turn_velocity;
+    float time = control_loop.elapsed_ms()/1000.0;
+    profile.sample(time);
+    float heading = sensors.heading;
+    motion.error = reduce_negative_180_to_180(angle - heading);
+    float error = reduce_negative_180_to_180(start_heading + profile.position - heading);
+    float output = turn_feedforward.calculate(profile.velocity, profile.acceleration) + turnPID.compute(error, sensors.time_us);
+    if (time < profile.duration){
+      turnPID.time_spent_settled = 0;
+      turnPID.consecutive_settled_count = 0;
+      turnPID.in_settle_band = false;
+    }
+    output = clamp(output, -12, 12);
+    drive_with_voltage(output, -output);
+    control_loop.wait();
+  }
+  end_motion(turnPID);
+  drive_stop(hold);
+}
+
+/**
+ * Characterization runs for the feedforward. Each one ramps the
+ * voltage slowly (quasistatic, so velocity tracks kS and kV), rests,
+ * then applies a voltage step (so acceleration shows up for kA). It
+ * does this forward and then in reverse, which brings the robot back
+ * near where it started. The fit is printed and applied to the chassis.
+ * Give the robot about 3 feet of clear space in front and behind.
+ * 
+ * @return True if the fit succeeded.
+ */
+
+bool Drive::characterize_drive(){
+  if (!characterize(false, 2, 4, 8, 0.5, drive_feedforward)){
+    return(false);
+  }
+  cout<<"chassis.set_drive_feedforward("<<drive_feedforward.kS<<", "<<drive_feedforward.kV<<", "<<drive_feedforward.kA<<");"<<endl;
+  Brain.Screen.printAt(5,20, "Drive kS: %f kV: %f kA: %f", drive_feedforward.kS, drive_feedforward.kV, drive_feedforward.kA);
+  return(true);
+}
+
+bool Drive::characterize_turn(){
+  if (!characterize(true, 3, 6, 8, 0.5, turn_feedforward)){
+    return(false);
+  }
+  cout<<"chassis.set_turn_feedforward("<<turn_feedforward.kS<<", "<<turn_feedforward.kV<<", "<<turn_feedforward.kA<<");"<<endl;
+  Brain.Screen.printAt(5,40, "Turn kS: %f kV: %f kA: %f", turn_feedforward.kS, turn_feedforward.kV, turn_feedforward.kA);
+  return(true);
+}
+
+/**
+ * Runs one characterization and fits it. Position comes from the
+ * drive encoders in inches, or the gyro's continuous rotation in
+ * degrees when turning. Velocity and acceleration are differenced
+ * each control loop tick, and ticks where the robot isn't moving
+ * are left out of the fit.
+ * 
+ * @param turning True to turn in place, false to drive straight.
+ * @param ramp_rate Quasistatic ramp rate in volts per second.
+ * @param ramp_voltage Voltage where the ramp stops.
+ * @param step_voltage Voltage of the dynamic step.
+ * @param step_time Length of the step in seconds.
+ * @param result Set to the fitted constants on success.
+ * @return True if the fit succeeded.
+ */
+
+bool Drive::characterize(bool turning, float ramp_rate, float ramp_voltage, float step_voltage, float step_time, Feedforward &result){
+  FeedforwardFit fit;
+  float min_velocity = turning ? 5 : 0.5;
+  for(int direction = 1; direction >= -1; direction -= 2){
+    for(int step = 0; step < 2; step++){
+      float duration = step ? step_time : ramp_voltage/ramp_rate;
+      sample_sensors();
+      float previous_position = turning ? sensors.rotation : (sensors.left_position_in+sensors.right_position_in)/2.0;
+      uint64_t previous_time_us = sensors.time_us;
+      float previous_velocity = 0;
+      float previous_dt = 0;
+      float voltage = 0;
+      int ticks = 0;
+      control_loop.start();
+      while(control_loop.elapsed_ms() < duration*1000){
+        sample_sensors();
+        float position = turning ? sensors.rotation : (sensors.left_position_in+sensors.right_position_in)/2.0;
+        // Differences over the measured time between samples, so a late
+        // tick doesn't read as a burst of speed. Each velocity is for the
+        // middle of its interval, so acceleration spans half of each.
+        float dt = (sensors.time_us-previous_time_us)/1000000.0;
+        if (dt <= 0){
+          control_loop.wait();
+          continue;
+        }
+        float velocity = (position-previous_position)/dt;
+        float acceleration = (velocity-previous_velocity)/((dt+previous_dt)/2);
+        if (ticks >= 2 && fabs(velocity) > min_velocity){
+          fit.add_sample(voltage, velocity, acceleration);
+        }
+        previous_position = position;
+        previous_time_us = sensors.time_us;
+        previous_velocity = velocity;
+        previous_dt = dt;
+        ticks++;
+
+        voltage = direction*(step ? step_voltage : fmin(ramp_rate*control_loop.elapsed_ms()/1000.0, ramp_voltage));
+        if (turning){
+          drive_with_voltage(voltage, -voltage);
+        } else {
+          drive_with_voltage(voltage, voltage);
+        }
+        control_loop.wait();
+      }
+      drive_stop(brake);
+      task::sleep(500);
+    }
+  }
+  drive_stop(coast);
+  return(fit.solve(result));
+}
 
 /**
  * Turns to a given angle with only one side of the drivetrain.
@@ -379,60 +843,57 @@ void Drive::drive_distance(float distance, float heading, float drive_max_voltag
  */
 
 void Drive::left_swing_to_angle(float angle){
-  left_swing_to_angle(angle, swing_max_voltage, swing_settle_error, swing_settle_time, swing_timeout, swing_kp, swing_ki, swing_kd, swing_starti);
+  GainPoint gains = swing_gains(angle);
+  left_swing_to_angle(angle, gains.max_voltage, gains.settle_error, gains.settle_time, swing_timeout, gains.kp, gains.ki, gains.kd, gains.starti);
 }
 
-void Drive::left_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti){
-  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time, swing_timeout);
+void Drive::left_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti, int settle_flags){
+  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time, swing_timeout, control_loop.period, settle_flags);
+  swingPID.derivative_filter = derivative_filter;
+  swingPID.settle_velocity = swing_settle_velocity;
+  begin_motion("left_swing_to_angle", swingPID.error);
+  control_loop.start();
   while(swingPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = swingPID.compute(error);
+    if(motion.cancelled){ break; }
+    sample_gyro();
+    swingPID.velocity = sensors.turn_velocity;
+    float error = reduce_negative_180_to_180(angle - sensors.heading);
+    motion.error = error;
+    float output = swingPID.compute(error, sensors.time_us);
     output = clamp(output, -swing_max_voltage, swing_max_voltage);
-    DriveL.spin(fwd, output, volt);
+    motion.peak_voltage = fmax(motion.peak_voltage, fabs(output));
+    DriveL.spin(fwd, battery.compensate(output*derating), volt);
     DriveR.stop(hold);
-    task::sleep(10);
-  }
-}
-
-void Drive::left_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, int swing_settle_flags, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti){
-  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_flags, swing_timeout);
-  while(swingPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = swingPID.compute(error);
-    output = clamp(output, -swing_max_voltage, swing_max_voltage);
-    DriveL.spin(fwd, output, volt);
-    DriveR.stop(hold);
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(swingPID);
 }
 
 void Drive::right_swing_to_angle(float angle){
-  right_swing_to_angle(angle, swing_max_voltage, swing_settle_error, swing_settle_time, swing_timeout, swing_kp, swing_ki, swing_kd, swing_starti);
-}
-
-void Drive::right_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti){
-  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time, swing_timeout);
-  while(swingPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = swingPID.compute(error);
-    output = clamp(output, -swing_max_voltage, swing_max_voltage);
-    DriveR.spin(vex::reverse, output, volt);
-    DriveL.stop(hold);
-    task::sleep(10);
-  }
-  chassis.drive_stop(hold);
+  GainPoint gains = swing_gains(angle);
+  right_swing_to_angle(angle, gains.max_voltage, gains.settle_error, gains.settle_time, swing_timeout, gains.kp, gains.ki, gains.kd, gains.starti);
 }
 
-void Drive::right_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, int swing_settle_flags, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti){
-  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_flags, swing_timeout);
+void Drive::right_swing_to_angle(float angle, float swing_max_voltage, float swing_settle_error, float swing_settle_time, float swing_timeout, float swing_kp, float swing_ki, float swing_kd, float swing_starti, int settle_flags){
+  PID swingPID(reduce_negative_180_to_180(angle - get_absolute_heading()), swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time, swing_timeout, control_loop.period, settle_flags);
+  swingPID.derivative_filter = derivative_filter;
+  swingPID.settle_velocity = swing_settle_velocity;
+  begin_motion("right_swing_to_angle", swingPID.error);
+  control_loop.start();
   while(swingPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(angle - get_absolute_heading());
-    float output = swingPID.compute(error);
+    if(motion.cancelled){ break; }
+    sample_gyro();
+    swingPID.velocity = sensors.turn_velocity;
+    float error = reduce_negative_180_to_180(angle - sensors.heading);
+    motion.error = error;
+    float output = swingPID.compute(error, sensors.time_us);
     output = clamp(output, -swing_max_voltage, swing_max_voltage);
-    DriveR.spin(vex::reverse, output, volt);
+    motion.peak_voltage = fmax(motion.peak_voltage, fabs(output));
+    DriveR.spin(vex::reverse, battery.compensate(output*derating), volt);
     DriveL.stop(hold);
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(swingPID);
   chassis.drive_stop(hold);
 }
 
@@ -474,9 +935,18 @@ float Drive::get_SidewaysTracker_position(){
  */
 
 void Drive::position_track(){
+  LoopTimer odom_loop(odom_period);
+  odom_loop.start();
   while(1){
-    odom.update_position(get_ForwardTracker_position(), get_SidewaysTracker_position(), get_absolute_heading());
-    task::sleep(5);
+    float ForwardTracker_position = get_ForwardTracker_position();
+    float SidewaysTracker_position = get_SidewaysTracker_position();
+    float orientation_deg = get_absolute_heading();
+    odom.update_position(ForwardTracker_position, SidewaysTracker_position, orientation_deg);
+    uint64_t time_us = odom_loop.tick_time_us;
+    telemetry.log(TELEMETRY_ODOM_UPDATE, 0, ForwardTracker_position, SidewaysTracker_position, time_us);
+    telemetry.log(TELEMETRY_ODOM_HEADING, 0, orientation_deg, 0, time_us);
+    telemetry.log(TELEMETRY_ODOM_POSE, 0, odom.X_position, odom.Y_position, time_us);
+    odom_loop.wait();
   }
 }
 
@@ -504,7 +974,14 @@ void Drive::set_heading(float orientation_deg){
  */
 
 void Drive::set_coordinates(float X_position, float Y_position, float orientation_deg){
-  odom.set_position(X_position, Y_position, orientation_deg, get_ForwardTracker_position(), get_SidewaysTracker_position());
+  float ForwardTracker_position = get_ForwardTracker_position();
+  float SidewaysTracker_position = get_SidewaysTracker_position();
+  odom.set_position(X_position, Y_position, orientation_deg, ForwardTracker_position, SidewaysTracker_position);
+  uint64_t time_us = vex::timer::systemHighResolution();
+  telemetry.log(TELEMETRY_ODOM_SET, 0, X_position, Y_position, time_us);
+  telemetry.log(TELEMETRY_ODOM_SET, 1, orientation_deg, ForwardTracker_position, time_us);
+  telemetry.log(TELEMETRY_ODOM_SET, 2, SidewaysTracker_position, odom.method, time_us);
+  telemetry.log(TELEMETRY_ODOM_SET, 3, odom.get_ForwardTracker_center_distance(), odom.get_SidewaysTracker_center_distance(), time_us);
   set_heading(orientation_deg);
   odom_task = task(position_track_task);
 }
@@ -516,7 +993,7 @@ void Drive::set_coordinates(float X_position, float Y_position, float orientatio
  */
 
 float Drive::get_X_position(){
-  return(odom.X_position);
+  return(odom.get_pose().X_position);
 }
 
 /**
@@ -526,7 +1003,7 @@ float Drive::get_X_position(){
  */
 
 float Drive::get_Y_position(){
-  return(odom.Y_position);
+  return(odom.get_pose().Y_position);
 }
 
 /**
@@ -549,65 +1026,38 @@ void Drive::drive_to_point(float X_position, float Y_position, float drive_min_v
   drive_to_point(X_position, Y_position, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
 }
 
-void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout){
-  drive_to_point(X_position, Y_position, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
-}
-
-void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout){
-  drive_to_point(X_position, Y_position, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_flags, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
-}
-
-void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout);
-  float start_angle_deg = to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()));
-  PID headingPID(start_angle_deg-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti);
-  bool line_settled = false;
-  bool prev_line_settled = is_line_settled(X_position, Y_position, start_angle_deg, get_X_position(), get_Y_position());
-  while(!drivePID.is_settled()){
-    line_settled = is_line_settled(X_position, Y_position, start_angle_deg, get_X_position(), get_Y_position());
-    if(line_settled && !prev_line_settled){ break; }
-    prev_line_settled = line_settled;
-
-    float drive_error = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-    float heading_error = reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()))-get_absolute_heading());
-    float drive_output = drivePID.compute(drive_error);
-
-    float heading_scale_factor = cos(to_rad(heading_error));
-    drive_output*=heading_scale_factor;
-    heading_error = reduce_negative_90_to_90(heading_error);
-    float heading_output = headingPID.compute(heading_error);
-    
-    if (drive_error<drive_settle_error) { heading_output = 0; }
-
-    drive_output = clamp(drive_output, -fabs(heading_scale_factor)*drive_max_voltage, fabs(heading_scale_factor)*drive_max_voltage);
-    heading_output = clamp(heading_output, -heading_max_voltage, heading_max_voltage);
-
-    drive_output = clamp_min_voltage(drive_output, drive_min_voltage);
-
-    drive_with_voltage(left_voltage_scaling(drive_output, heading_output), right_voltage_scaling(drive_output, heading_output));
-    task::sleep(10);
-  }
+void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags){
+  drive_to_point(X_position, Y_position, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti, settle_flags);
 }
 
-void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_flags, drive_timeout);
+void Drive::drive_to_point(float X_position, float Y_position, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags){
+  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout, control_loop.period, settle_flags);
+  drivePID.derivative_filter = derivative_filter;
+  drivePID.settle_velocity = drive_settle_velocity;
   float start_angle_deg = to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()));
   PID headingPID(start_angle_deg-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti);
+  headingPID.derivative_filter = derivative_filter;
   bool line_settled = false;
   bool prev_line_settled = is_line_settled(X_position, Y_position, start_angle_deg, get_X_position(), get_Y_position());
+  begin_motion("drive_to_point", drivePID.error);
+  control_loop.start();
   while(!drivePID.is_settled()){
-    line_settled = is_line_settled(X_position, Y_position, start_angle_deg, get_X_position(), get_Y_position());
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    drivePID.velocity = sensors.forward_velocity;
+    line_settled = is_line_settled(X_position, Y_position, start_angle_deg, sensors.X_position, sensors.Y_position);
     if(line_settled && !prev_line_settled){ break; }
     prev_line_settled = line_settled;
 
-    float drive_error = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-    float heading_error = reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()))-get_absolute_heading());
-    float drive_output = drivePID.compute(drive_error);
+    float drive_error = hypot(X_position-sensors.X_position,Y_position-sensors.Y_position);
+    motion.error = drive_error;
+    float heading_error = reduce_negative_180_to_180(to_deg(fast_atan2(X_position-sensors.X_position,Y_position-sensors.Y_position))-sensors.heading);
+    float drive_output = drivePID.compute(drive_error, sensors.time_us);
 
-    float heading_scale_factor = cos(to_rad(heading_error));
+    float heading_scale_factor = fast_cos(to_rad(heading_error));
     drive_output*=heading_scale_factor;
     heading_error = reduce_negative_90_to_90(heading_error);
-    float heading_output = headingPID.compute(heading_error);
+    float heading_output = headingPID.compute(heading_error, sensors.time_us);
     
     if (drive_error<drive_settle_error) { heading_output = 0; }
 
@@ -617,8 +1067,9 @@ void Drive::drive_to_point(float X_position, float Y_position, float drive_min_v
     drive_output = clamp_min_voltage(drive_output, drive_min_voltage);
 
     drive_with_voltage(left_voltage_scaling(drive_output, heading_output), right_voltage_scaling(drive_output, heading_output));
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(drivePID);
 }
 
 /**
@@ -653,52 +1104,57 @@ void Drive::drive_to_pose(float X_position, float Y_position, float angle, float
 }
 
 
-void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout){
-  drive_to_pose(X_position, Y_position, angle, lead, setback, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags){
+  drive_to_pose(X_position, Y_position, angle, lead, setback, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti, settle_flags);
 }
 
-void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout){
-  drive_to_pose(X_position, Y_position, angle, lead, setback, drive_min_voltage, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_flags, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
-}
-
-void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
+void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags){
   float target_distance = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-  PID drivePID(target_distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout);
+  PID drivePID(target_distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout, control_loop.period, settle_flags);
+  drivePID.derivative_filter = derivative_filter;
+  drivePID.settle_velocity = drive_settle_velocity;
   PID headingPID(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()))-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti);
+  headingPID.derivative_filter = derivative_filter;
   bool line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
   bool prev_line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
   bool crossed_center_line = false;
   bool center_line_side = is_line_settled(X_position, Y_position, angle+90, get_X_position(), get_Y_position());
   bool prev_center_line_side = center_line_side;
+  begin_motion("drive_to_pose", target_distance);
+  control_loop.start();
   while(!drivePID.is_settled()){
-    line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    drivePID.velocity = sensors.forward_velocity;
+    line_settled = is_line_settled(X_position, Y_position, angle, sensors.X_position, sensors.Y_position);
     if(line_settled && !prev_line_settled){ break; }
     prev_line_settled = line_settled;
 
-    center_line_side = is_line_settled(X_position, Y_position, angle+90, get_X_position(), get_Y_position());
+    center_line_side = is_line_settled(X_position, Y_position, angle+90, sensors.X_position, sensors.Y_position);
     if(center_line_side != prev_center_line_side){
       crossed_center_line = true;
     }
 
-    target_distance = hypot(X_position-get_X_position(),Y_position-get_Y_position());
+    target_distance = hypot(X_position-sensors.X_position,Y_position-sensors.Y_position);
+    motion.error = target_distance;
 
     float carrot_X = X_position - sin(to_rad(angle)) * (lead * target_distance + setback);
     float carrot_Y = Y_position - cos(to_rad(angle)) * (lead * target_distance + setback);
 
-    float drive_error = hypot(carrot_X-get_X_position(),carrot_Y-get_Y_position());
-    float heading_error = reduce_negative_180_to_180(to_deg(atan2(carrot_X-get_X_position(),carrot_Y-get_Y_position()))-get_absolute_heading());
+    float drive_error = hypot(carrot_X-sensors.X_position,carrot_Y-sensors.Y_position);
+    float heading_error = reduce_negative_180_to_180(to_deg(fast_atan2(carrot_X-sensors.X_position,carrot_Y-sensors.Y_position))-sensors.heading);
 
     if (drive_error<drive_settle_error || crossed_center_line || drive_error < setback) { 
-      heading_error = reduce_negative_180_to_180(angle-get_absolute_heading()); 
+      heading_error = reduce_negative_180_to_180(angle-sensors.heading); 
       drive_error = target_distance;
     }
     
-    float drive_output = drivePID.compute(drive_error);
+    float drive_output = drivePID.compute(drive_error, sensors.time_us);
 
-    float heading_scale_factor = cos(to_rad(heading_error));
+    float heading_scale_factor = fast_cos(to_rad(heading_error));
     drive_output*=heading_scale_factor;
     heading_error = reduce_negative_90_to_90(heading_error);
-    float heading_output = headingPID.compute(heading_error);
+    float heading_output = headingPID.compute(heading_error, sensors.time_us);
 
     drive_output = clamp(drive_output, -fabs(heading_scale_factor)*drive_max_voltage, fabs(heading_scale_factor)*drive_max_voltage);
     heading_output = clamp(heading_output, -heading_max_voltage, heading_max_voltage);
@@ -706,56 +1162,121 @@ void Drive::drive_to_pose(float X_position, float Y_position, float angle, float
     drive_output = clamp_min_voltage(drive_output, drive_min_voltage);
 
     drive_with_voltage(left_voltage_scaling(drive_output, heading_output), right_voltage_scaling(drive_output, heading_output));
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(drivePID);
 }
 
-void Drive::drive_to_pose(float X_position, float Y_position, float angle, float lead, float setback, float drive_min_voltage, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  float target_distance = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-  PID drivePID(target_distance, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_flags, drive_timeout);
-  PID headingPID(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position()))-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti);
-  bool line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
-  bool prev_line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
-  bool crossed_center_line = false;
-  bool center_line_side = is_line_settled(X_position, Y_position, angle+90, get_X_position(), get_Y_position());
-  bool prev_center_line_side = center_line_side;
-  while(!drivePID.is_settled()){
-    line_settled = is_line_settled(X_position, Y_position, angle, get_X_position(), get_Y_position());
-    if(line_settled && !prev_line_settled){ break; }
-    prev_line_settled = line_settled;
-
-    center_line_side = is_line_settled(X_position, Y_position, angle+90, get_X_position(), get_Y_position());
-    if(center_line_side != prev_center_line_side){
-      crossed_center_line = true;
-    }
+/**
+ * Follows a waypoint path with pure pursuit, without stopping at the
+ * waypoints. Each tick it finds the closest point on the path to the
+ * odom position, aims at the point lookahead inches further along,
+ * and steers on the arc through it. Speed follows the drive profile
+ * limits, slowing in tight curves and ramping down to end_velocity at
+ * the end of the path. Both speed and turn rate go through the drive
+ * and turn feedforward. With an end_velocity above 0 it leaves the
+ * motors running, so the next motion can pick up without stopping.
+ * Needs an odom drive setup and set_coordinates().
+ * 
+ * @param path Waypoints to follow, starting near the robot.
+ * @param lookahead Lookahead distance in inches. Longer is smoother, shorter cuts corners less.
+ * @param end_velocity Speed in inches per second to finish the path at.
+ * @param reversed True to drive the path backwards.
+ */
 
-    target_distance = hypot(X_position-get_X_position(),Y_position-get_Y_position());
+void Drive::follow_path(Path &path){
+  follow_path(path, path_lookahead, 0, false, drive_max_velocity, drive_settle_error, drive_timeout);
+}
 
-    float carrot_X = X_position - sin(to_rad(angle)) * (lead * target_distance + setback);
-    float carrot_Y = Y_position - cos(to_rad(angle)) * (lead * target_distance + setback);
+void Drive::follow_path(Path &path, float lookahead){
+  follow_path(path, lookahead, 0, false, drive_max_velocity, drive_settle_error, drive_timeout);
+}
 
-    float drive_error = hypot(carrot_X-get_X_position(),carrot_Y-get_Y_position());
-    float heading_error = reduce_negative_180_to_180(to_deg(atan2(carrot_X-get_X_position(),carrot_Y-get_Y_position()))-get_absolute_heading());
+void Drive::follow_path(Path &path, float lookahead, float end_velocity, bool reversed){
+  follow_path(path, lookahead, end_velocity, reversed, drive_max_velocity, drive_settle_error, drive_timeout);
+}
 
-    if (drive_error<drive_settle_error || crossed_center_line || drive_error < setback) { 
-      heading_error = reduce_negative_180_to_180(angle-get_absolute_heading()); 
-      drive_error = target_distance;
+void Drive::follow_path(Path &path, float lookahead, float end_velocity, bool reversed, float max_velocity, float drive_settle_error, float drive_timeout){
+  if (path.count < 2){
+    return;
+  }
+  int last = path.count-1;
+  float end_direction_X = (path.X_position[last]-path.X_position[last-1])/(path.distance[last]-path.distance[last-1]);
+  float end_direction_Y = (path.Y_position[last]-path.Y_position[last-1])/(path.distance[last]-path.distance[last-1]);
+  float direction = reversed ? -1 : 1;
+  uint64_t previous_time_us = 0;
+  int segment = 0;
+  float progress = 0;
+  float velocity = 0;
+
+  begin_motion("follow_path", path.length);
+  uint8_t exit_reason = SETTLE_TIMEOUT;
+  control_loop.start();
+  while(drive_timeout == 0 || control_loop.elapsed_ms() < drive_timeout){
+    if(motion.cancelled){
+      exit_reason = SETTLE_RUNNING;
+      break;
+    }
+    sample_sensors();
+    // Step the speed by the time that actually passed since the last
+    // tick, so a late tick doesn't under-accelerate.
+    float dt = control_loop.period/1000.0;
+    if (previous_time_us != 0){
+      dt = (sensors.time_us-previous_time_us)/1000000.0;
+    }
+    previous_time_us = sensors.time_us;
+    float X = sensors.X_position;
+    float Y = sensors.Y_position;
+    segment = path.closest_segment(X, Y, segment, 3, progress);
+    float remaining = path.length-progress;
+    motion.error = remaining;
+
+    // Distance to the end measured along the last segment, so passing
+    // the end to one side still finishes the path.
+    float end_along = (path.X_position[last]-X)*end_direction_X + (path.Y_position[last]-Y)*end_direction_Y;
+    if (segment == last-1 && end_along < drive_settle_error){
+      exit_reason = SETTLE_IN_BAND;
+      break;
     }
-    
-    float drive_output = drivePID.compute(drive_error);
 
-    float heading_scale_factor = cos(to_rad(heading_error));
-    drive_output*=heading_scale_factor;
-    heading_error = reduce_negative_90_to_90(heading_error);
-    float heading_output = headingPID.compute(heading_error);
+    // Near the end, aim past the last point along the final segment
+    // so the robot drives through it straight instead of curling in.
+    float target_X, target_Y;
+    path.point_at(progress+lookahead, segment, target_X, target_Y);
+    if (progress+lookahead > path.length){
+      target_X += end_direction_X*(progress+lookahead-path.length);
+      target_Y += end_direction_Y*(progress+lookahead-path.length);
+    }
 
-    drive_output = clamp(drive_output, -fabs(heading_scale_factor)*drive_max_voltage, fabs(heading_scale_factor)*drive_max_voltage);
-    heading_output = clamp(heading_output, -heading_max_voltage, heading_max_voltage);
+    float heading = to_rad(sensors.heading);
+    if (reversed){ heading += M_PI; }
+    float dX = target_X-X;
+    float dY = target_Y-Y;
+    float sin_heading, cos_heading;
+    fast_sincos(heading, sin_heading, cos_heading);
+    float lateral = dX*cos_heading - dY*sin_heading;
+    float target_distance_sq = dX*dX + dY*dY;
+    float curvature = target_distance_sq > 0 ? 2*lateral/target_distance_sq : 0;
+
+    float target_velocity = fmin(max_velocity, sqrt(end_velocity*end_velocity + 2*drive_max_acceleration*fmax(end_along, 0)));
+    if (curvature != 0){
+      target_velocity = fmin(target_velocity, to_rad(turn_max_velocity)/fabs(curvature));
+    }
+    float acceleration = 0;
+    if (dt > 0){
+      acceleration = clamp((target_velocity-velocity)/dt, -drive_max_acceleration, drive_max_acceleration);
+      velocity += acceleration*dt;
+    }
 
-    drive_output = clamp_min_voltage(drive_output, drive_min_voltage);
+    float drive_output = drive_feedforward.calculate(direction*velocity, direction*acceleration);
+    float turn_output = turn_feedforward.kV*to_deg(velocity*curvature);
 
-    drive_with_voltage(left_voltage_scaling(drive_output, heading_output), right_voltage_scaling(drive_output, heading_output));
-    task::sleep(10);
+    drive_with_voltage(left_voltage_scaling(drive_output, turn_output), right_voltage_scaling(drive_output, turn_output));
+    control_loop.wait();
+  }
+  end_motion(exit_reason, 0, motion.error);
+  if (end_velocity == 0){
+    drive_stop(hold);
   }
 }
 
@@ -779,34 +1300,28 @@ void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_
   turn_to_point(X_position, Y_position, extra_angle_deg, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
 }
 
-void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout){
-  turn_to_point(X_position, Y_position, extra_angle_deg, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
+void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, int settle_flags){
+  turn_to_point(X_position, Y_position, extra_angle_deg, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti, settle_flags);
 }
 
-void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, int turn_settle_flags, float turn_timeout){
-  turn_to_point(X_position, Y_position, extra_angle_deg, turn_max_voltage, turn_settle_error, turn_settle_flags, turn_timeout, turn_kp, turn_ki, turn_kd, turn_starti);
-}
-
-void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti){
-  PID turnPID(reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position())) - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time, turn_timeout);
+void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti, int settle_flags){
+  PID turnPID(reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position())) - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_time, turn_timeout, control_loop.period, settle_flags);
+  turnPID.derivative_filter = derivative_filter;
+  turnPID.settle_velocity = turn_settle_velocity;
+  begin_motion("turn_to_point", reduce_negative_180_to_180(turnPID.error + extra_angle_deg));
+  control_loop.start();
   while(turnPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position())) - get_absolute_heading() + extra_angle_deg);
-    float output = turnPID.compute(error);
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    turnPID.velocity = sensors.turn_velocity;
+    float error = reduce_negative_180_to_180(to_deg(fast_atan2(X_position-sensors.X_position,Y_position-sensors.Y_position)) - sensors.heading + extra_angle_deg);
+    motion.error = error;
+    float output = turnPID.compute(error, sensors.time_us);
     output = clamp(output, -turn_max_voltage, turn_max_voltage);
     drive_with_voltage(output, -output);
-    task::sleep(10);
-  }
-}
-
-void Drive::turn_to_point(float X_position, float Y_position, float extra_angle_deg, float turn_max_voltage, float turn_settle_error, int turn_settle_flags, float turn_timeout, float turn_kp, float turn_ki, float turn_kd, float turn_starti){
-  PID turnPID(reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position())) - get_absolute_heading()), turn_kp, turn_ki, turn_kd, turn_starti, turn_settle_error, turn_settle_flags, turn_timeout);
-  while(turnPID.is_settled() == false){
-    float error = reduce_negative_180_to_180(to_deg(atan2(X_position-get_X_position(),Y_position-get_Y_position())) - get_absolute_heading() + extra_angle_deg);
-    float output = turnPID.compute(error);
-    output = clamp(output, -turn_max_voltage, turn_max_voltage);
-    drive_with_voltage(output, -output);
-    task::sleep(10);
+    control_loop.wait();
   }
+  end_motion(turnPID);
 }
 
 /**
@@ -833,97 +1348,253 @@ void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float an
   holonomic_drive_to_pose(X_position, Y_position, angle, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
 }
 
-void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout){
-  holonomic_drive_to_pose(X_position, Y_position, angle, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
-}
-
-void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout){
-  holonomic_drive_to_pose(X_position, Y_position, angle, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_flags, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti);
+void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, int settle_flags){
+  holonomic_drive_to_pose(X_position, Y_position, angle, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout, drive_kp, drive_ki, drive_kd, drive_starti, heading_kp, heading_ki, heading_kd, heading_starti, settle_flags);
 }
 
-void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout);
-  PID turnPID(angle-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti, turn_settle_error, turn_settle_time, turn_timeout);
+void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti, int settle_flags){
+  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout, control_loop.period, settle_flags);
+  drivePID.derivative_filter = derivative_filter;
+  PID turnPID(angle-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti, turn_settle_error, turn_settle_time, turn_timeout, control_loop.period, settle_flags);
+  turnPID.derivative_filter = derivative_filter;
+  turnPID.telemetry_source = TELEMETRY_AUX_PID_TICK;
+  begin_motion("holonomic_drive_to_pose", drivePID.error);
+  control_loop.start();
   while( !(drivePID.is_settled() && turnPID.is_settled()) ){
-    float drive_error = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-    float turn_error = reduce_negative_180_to_180(angle-get_absolute_heading());
+    if(motion.cancelled){ break; }
+    sample_sensors();
+    float drive_error = hypot(X_position-sensors.X_position,Y_position-sensors.Y_position);
+    motion.error = drive_error;
+    float turn_error = reduce_negative_180_to_180(angle-sensors.heading);
 
-    float drive_output = drivePID.compute(drive_error);
-    float turn_output = turnPID.compute(turn_error);
+    float drive_output = drivePID.compute(drive_error, sensors.time_us);
+    float turn_output = turnPID.compute(turn_error, sensors.time_us);
 
     drive_output = clamp(drive_output, -drive_max_voltage, drive_max_voltage);
     turn_output = clamp(turn_output, -heading_max_voltage, heading_max_voltage);
 
-    float heading_error = atan2(Y_position-get_Y_position(), X_position-get_X_position());
+    float heading_error = atan2(Y_position-sensors.Y_position, X_position-sensors.X_position);
 
-    DriveLF.spin(fwd, drive_output*cos(to_rad(get_absolute_heading()) + heading_error - M_PI/4) + turn_output, volt);
-    DriveLB.spin(fwd, drive_output*cos(-to_rad(get_absolute_heading()) - heading_error + 3*M_PI/4) + turn_output, volt);
-    DriveRB.spin(fwd, drive_output*cos(to_rad(get_absolute_heading()) + heading_error - M_PI/4) - turn_output, volt);
-    DriveRF.spin(fwd, drive_output*cos(-to_rad(get_absolute_heading()) - heading_error + 3*M_PI/4) - turn_output, volt);
-    task::sleep(10);
+    float LF_voltage = drive_output*cos(to_rad(sensors.heading) + heading_error - M_PI/4) + turn_output;
+    float LB_voltage = drive_output*cos(-to_rad(sensors.heading) - heading_error + 3*M_PI/4) + turn_output;
+    float RB_voltage = drive_output*cos(to_rad(sensors.heading) + heading_error - M_PI/4) - turn_output;
+    float RF_voltage = drive_output*cos(-to_rad(sensors.heading) - heading_error + 3*M_PI/4) - turn_output;
+    motion.peak_voltage = fmax(motion.peak_voltage, fmax(fmax(fabs(LF_voltage), fabs(LB_voltage)), fmax(fabs(RB_voltage), fabs(RF_voltage))));
+
+    DriveLF.spin(fwd, battery.compensate(LF_voltage*derating), volt);
+    DriveLB.spin(fwd, battery.compensate(LB_voltage*derating), volt);
+    DriveRB.spin(fwd, battery.compensate(RB_voltage*derating), volt);
+    DriveRF.spin(fwd, battery.compensate(RF_voltage*derating), volt);
+    control_loop.wait();
   }
+  end_motion(drivePID);
 }
 
-void Drive::holonomic_drive_to_pose(float X_position, float Y_position, float angle, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, int drive_settle_flags, float drive_timeout, float drive_kp, float drive_ki, float drive_kd, float drive_starti, float heading_kp, float heading_ki, float heading_kd, float heading_starti){
-  PID drivePID(hypot(X_position-get_X_position(),Y_position-get_Y_position()), drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_flags, drive_timeout);
-  PID turnPID(angle-get_absolute_heading(), heading_kp, heading_ki, heading_kd, heading_starti, turn_settle_error, turn_settle_time, turn_timeout);
-  while( !(drivePID.is_settled() && turnPID.is_settled()) ){
-    float drive_error = hypot(X_position-get_X_position(),Y_position-get_Y_position());
-    float turn_error = reduce_negative_180_to_180(angle-get_absolute_heading());
+/**
+ * Records the starting error of a motion so handles can report
+ * progress, and starts its step in the auton profiler. A blocking
+ * motion that isn't running inside an async task gets a new id, which
+ * marks older handles as done.
+ * 
+ * @param name Motion name for the profiler.
+ * @param start_error Error when the motion starts, in inches or degrees.
+ */
 
-    float drive_output = drivePID.compute(drive_error);
-    float turn_output = turnPID.compute(turn_error);
+void Drive::begin_motion(const char *name, float start_error){
+  if (!motion.running){
+    motion.id++;
+  }
+  motion.started = true;
+  motion.start_error = start_error;
+  motion.error = start_error;
+  motion.peak_voltage = 0;
+  motion.profile_step = profiler.begin(name, motion.id, start_error);
+  telemetry.motion_id = motion.id;
+}
 
-    drive_output = clamp(drive_output, -drive_max_voltage, drive_max_voltage);
-    turn_output = clamp(turn_output, -heading_max_voltage, heading_max_voltage);
+/**
+ * Ends the motion's step in the auton profiler.
+ * 
+ * @param exit_reason Why it ended, as a settle_state.
+ * @param settle_count Consecutive ticks it had been inside its settle error.
+ * @param final_error Error at the end, in inches or degrees.
+ */
+
+void Drive::end_motion(uint8_t exit_reason, int settle_count, float final_error){
+  profiler.end(motion.profile_step, exit_reason, settle_count, final_error, motion.peak_voltage);
+  motion.profile_step = -1;
+}
+
+void Drive::end_motion(PID &pid){
+  end_motion(pid.settle_reason, pid.consecutive_settled_count, pid.previous_error);
+}
+
+/**
+ * Runs a motion in a background task and returns right away.
+ * If another async motion is still running, this waits for it to
+ * finish first, so async motions run in the order they're started.
+ * Don't start a blocking motion until the async one is done, since
+ * both would drive the motors.
+ * 
+ * @param command Motion to run, usually a lambda calling a blocking motion.
+ * @return Handle to wait on or query the motion.
+ */
 
-    float heading_error = atan2(Y_position-get_Y_position(), X_position-get_X_position());
+Motion Drive::start_motion(std::function<void()> command){
+  Motion(this, motion.id).wait();
+  motion.id++;
+  motion.running = true;
+  motion.cancelled = false;
+  motion.started = false;
+  motion.start_error = 0;
+  motion.error = 0;
+  motion_command = command;
+  motion_task = task(motion_task_entry, this);
+  return(Motion(this, motion.id));
+}
+
+/**
+ * Background task for async motions.
+ * 
+ * @param drive Chassis that started the motion.
+ */
 
-    DriveLF.spin(fwd, drive_output*cos(to_rad(get_absolute_heading()) + heading_error - M_PI/4) + turn_output, volt);
-    DriveLB.spin(fwd, drive_output*cos(-to_rad(get_absolute_heading()) - heading_error + 3*M_PI/4) + turn_output, volt);
-    DriveRB.spin(fwd, drive_output*cos(to_rad(get_absolute_heading()) + heading_error - M_PI/4) - turn_output, volt);
-    DriveRF.spin(fwd, drive_output*cos(-to_rad(get_absolute_heading()) - heading_error + 3*M_PI/4) - turn_output, volt);
-    task::sleep(10);
+int Drive::motion_task_entry(void *drive){
+  Drive *self = (Drive*)drive;
+  self->motion_command();
+  self->motion.running = false;
+  self->motion.cancelled = false;
+  return(0);
+}
+
+/**
+ * Async versions of the motions. Each takes the same parameters as
+ * its blocking version, starts it in the background with
+ * start_motion(), and returns a handle. For example:
+ * 
+ * Motion m = chassis.drive_distance_async(24);
+ * m.wait_until(12);
+ * bottomRoller.spin(fwd, 12, volt);
+ * m.wait();
+ */
+
+Motion Drive::turn_to_angle_async(float angle){
+  return(start_motion([=](){ turn_to_angle(angle); }));
+}
+
+Motion Drive::turn_to_angle_async(float angle, float turn_max_voltage){
+  return(start_motion([=](){ turn_to_angle(angle, turn_max_voltage); }));
+}
+
+Motion Drive::turn_to_angle_async(float angle, float turn_max_voltage, float turn_settle_error, float turn_settle_time, float turn_timeout){
+  return(start_motion([=](){ turn_to_angle(angle, turn_max_voltage, turn_settle_error, turn_settle_time, turn_timeout); }));
+}
+
+Motion Drive::drive_distance_async(float distance){
+  return(start_motion([=](){ drive_distance(distance); }));
+}
+
+Motion Drive::drive_distance_async(float distance, float heading){
+  return(start_motion([=](){ drive_distance(distance, heading); }));
+}
+
+Motion Drive::drive_distance_async(float distance, float heading, float drive_max_voltage, float heading_max_voltage){
+  return(start_motion([=](){ drive_distance(distance, heading, drive_max_voltage, heading_max_voltage); }));
+}
+
+Motion Drive::drive_distance_async(float distance, float heading, float drive_max_voltage, float heading_max_voltage, float drive_settle_error, float drive_settle_time, float drive_timeout){
+  return(start_motion([=](){ drive_distance(distance, heading, drive_max_voltage, heading_max_voltage, drive_settle_error, drive_settle_time, drive_timeout); }));
+}
+
+Motion Drive::left_swing_to_angle_async(float angle){
+  return(start_motion([=](){ left_swing_to_angle(angle); }));
+}
+
+Motion Drive::right_swing_to_angle_async(float angle){
+  return(start_motion([=](){ right_swing_to_angle(angle); }));
+}
+
+Motion Drive::drive_to_point_async(float X_position, float Y_position){
+  return(start_motion([=](){ drive_to_point(X_position, Y_position); }));
+}
+
+Motion Drive::drive_to_pose_async(float X_position, float Y_position, float angle){
+  return(start_motion([=](){ drive_to_pose(X_position, Y_position, angle); }));
+}
+
+Motion Drive::turn_to_point_async(float X_position, float Y_position){
+  return(start_motion([=](){ turn_to_point(X_position, Y_position); }));
+}
+
+/**
+ * Shapes a stick value into a voltage with a response curve.
+ * 
+ * @param curve Curve to use, or nullptr for a deadband of 5.
+ * @param value Stick value from -127 to 127.
+ * @return Voltage out of 12.
+ */
+
+float Drive::joystick_voltage(const JoystickCurve *curve, int32_t value){
+  if (curve == nullptr){
+    return(to_volt(deadband(value, 5)));
   }
+  return(curve->voltage(value));
 }
 
 /**
  * Controls a chassis with left stick throttle and right stick turning.
- * Default deadband is 5.
+ * The sticks go through the joystick curves, or a deadband of 5 without
+ * them. Like the other control functions, it sends through
+ * MotorCommand, so voltages only go out when they change.
  */
 
 void Drive::control_arcade(){
-  float throttle = deadband(controller(primary).Axis3.value(), 5);
-  float turn = deadband(controller(primary).Axis1.value(), 5);
-  DriveL.spin(fwd, to_volt(throttle+turn), volt);
-  DriveR.spin(fwd, to_volt(throttle-turn), volt);
+  float throttle = joystick_voltage(throttle_curve, controller(primary).Axis3.value());
+  float turn = joystick_voltage(turn_curve, controller(primary).Axis1.value());
+  DriveL_command.spin(battery.compensate((throttle+turn)*derating));
+  DriveR_command.spin(battery.compensate((throttle-turn)*derating));
 }
 
 /**
  * Controls a chassis with left stick throttle and strafe, and right stick turning.
- * Default deadband is 5.
+ * The sticks go through the joystick curves, or a deadband of 5 without them.
  */
 
 void Drive::control_holonomic(){
-  float throttle = deadband(controller(primary).Axis3.value(), 5);
-  float turn = deadband(controller(primary).Axis1.value(), 5);
-  float strafe = deadband(controller(primary).Axis4.value(), 5);
-  DriveLF.spin(fwd, to_volt(throttle+turn+strafe), volt);
-  DriveRF.spin(fwd, to_volt(throttle-turn-strafe), volt);
-  DriveLB.spin(fwd, to_volt(throttle+turn-strafe), volt);
-  DriveRB.spin(fwd, to_volt(throttle-turn+strafe), volt);
+  float throttle = joystick_voltage(throttle_curve, controller(primary).Axis3.value());
+  float turn = joystick_voltage(turn_curve, controller(primary).Axis1.value());
+  float strafe = joystick_voltage(throttle_curve, controller(primary).Axis4.value());
+  DriveLF_command.spin(battery.compensate((throttle+turn+strafe)*derating));
+  DriveRF_command.spin(battery.compensate((throttle-turn-strafe)*derating));
+  DriveLB_command.spin(battery.compensate((throttle+turn-strafe)*derating));
+  DriveRB_command.spin(battery.compensate((throttle-turn+strafe)*derating));
 }
 
 /**
  * Controls a chassis with left stick left drive and right stick right drive.
- * Default deadband is 5.
+ * Both sticks go through the throttle curve, or a deadband of 5 without it.
  */
 
 void Drive::control_tank(){
-  float leftthrottle = deadband(controller(primary).Axis3.value(), 5);
-  float rightthrottle = deadband(controller(primary).Axis2.value(), 5);
-  DriveL.spin(fwd, to_volt(leftthrottle), volt);
-  DriveR.spin(fwd, to_volt(rightthrottle), volt);
+  float leftthrottle = joystick_voltage(throttle_curve, controller(primary).Axis3.value());
+  float rightthrottle = joystick_voltage(throttle_curve, controller(primary).Axis2.value());
+  DriveL_command.spin(battery.compensate(leftthrottle*derating));
+  DriveR_command.spin(battery.compensate(rightthrottle*derating));
+}
+
+/**
+ * Makes the next driver control command go out to every drive motor.
+ * Call it when driver control starts, since auton motions drive the
+ * motors directly.
+ */
+
+void Drive::invalidate_commands(){
+  DriveL_command.invalidate();
+  DriveR_command.invalidate();
+  DriveLF_command.invalidate();
+  DriveRF_command.invalidate();
+  DriveLB_command.invalidate();
+  DriveRB_command.invalidate();
 }
 
 /**
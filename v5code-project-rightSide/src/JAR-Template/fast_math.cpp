@@ -0,0 +1,207 @@
+#include "vex.h"
+#include <stdint.h>
+#if defined(__ARM_NEON) || defined(SIM_NEON)
+#include <arm_neon.h>
+#define FAST_MATH_NEON 1
+#endif
+
+// pi/2 split in three, the first two with short mantissas so k times
+// them is exact, so k*pi/2 comes off with little rounding.
+static const float pio2_1 = 1.5703125f;
+static const float pio2_2 = 4.837512969970703125e-4f;
+static const float pio2_3 = 7.54978995489188216e-8f;
+static const float two_over_pi = 6.3661977237e-01f;
+
+// Polynomials for sin and cos on [-pi/4, pi/4], from Cephes.
+static const float sin_c1 = -1.6666654611e-01f;
+static const float sin_c2 = 8.3321608736e-03f;
+static const float sin_c3 = -1.9515295891e-04f;
+static const float cos_c1 = 4.1666645683e-02f;
+static const float cos_c2 = -1.3887316255e-03f;
+static const float cos_c3 = 2.4433157117e-05f;
+
+// Odd polynomial for atan on [0, 1].
+static const float atan_c1 = 9.9997726e-01f;
+static const float atan_c3 = -3.3262347e-01f;
+static const float atan_c5 = 1.9354346e-01f;
+static const float atan_c7 = -1.1643287e-01f;
+static const float atan_c9 = 5.2653320e-02f;
+static const float atan_c11 = -1.1721200e-02f;
+
+/**
+ * Sine and cosine together, sharing the range reduction. x is split
+ * into k quarter turns plus a remainder in [-pi/4, pi/4], both
+ * polynomials are evaluated, and k picks which one is sin and which
+ * signs apply. Checked out to |x| = 1e4.
+ * 
+ * @param x Angle in radians.
+ * @param sin_x Set to sin(x).
+ * @param cos_x Set to cos(x).
+ */
+
+void fast_sincos(float x, float &sin_x, float &cos_x){
+  float scaled = x*two_over_pi;
+  int32_t k = (int32_t)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+  float kf = (float)k;
+  float r = ((x - kf*pio2_1) - kf*pio2_2) - kf*pio2_3;
+  float r2 = r*r;
+  float s = r + r*r2*(sin_c1 + r2*(sin_c2 + r2*sin_c3));
+  float c = 1.0f - 0.5f*r2 + r2*r2*(cos_c1 + r2*(cos_c2 + r2*cos_c3));
+  bool swap = k & 1;
+  float sin_value = swap ? c : s;
+  float cos_value = swap ? s : c;
+  sin_x = (k & 2) ? -sin_value : sin_value;
+  cos_x = ((k+1) & 2) ? -cos_value : cos_value;
+}
+
+float fast_sin(float x){
+  float s, c;
+  fast_sincos(x, s, c);
+  return(s);
+}
+
+float fast_cos(float x){
+  float s, c;
+  fast_sincos(x, s, c);
+  return(c);
+}
+
+/**
+ * Four-quadrant arctangent. The smaller of |x| and |y| over the larger
+ * is in [0, 1], where one polynomial covers atan, and the octant then
+ * unfolds it.
+ * 
+ * @param y Y component.
+ * @param x X component.
+ * @return Angle in radians in [-pi, pi], 0 when both are 0.
+ */
+
+float fast_atan2(float y, float x){
+  float ax = fabsf(x);
+  float ay = fabsf(y);
+  float larger = ax > ay ? ax : ay;
+  float smaller = ax > ay ? ay : ax;
+  float a = larger > 0 ? smaller/larger : 0;
+  float a2 = a*a;
+  float r = a*(atan_c1 + a2*(atan_c3 + a2*(atan_c5 + a2*(atan_c7 + a2*(atan_c9 + a2*atan_c11)))));
+  if (ay > ax){ r = (float)M_PI_2 - r; }
+  if (x < 0){ r = (float)M_PI - r; }
+  return(y < 0 ? -r : r);
+}
+
+#ifdef FAST_MATH_NEON
+/**
+ * Rounds each lane to the nearest whole number. ARMv7 NEON has no
+ * rounding instruction, so it adds a signed half and truncates.
+ */
+
+static inline int32x4_t round_to_int(float32x4_t x){
+  uint32x4_t negative = vcltq_f32(x, vdupq_n_f32(0));
+  float32x4_t half = vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+  return(vcvtq_s32_f32(vaddq_f32(x, half)));
+}
+
+/**
+ * floorf() for each lane, by truncating and stepping down one where
+ * truncation rounded a negative value up.
+ */
+
+static inline float32x4_t floor_lanes(float32x4_t x){
+  float32x4_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(x));
+  uint32x4_t rounded_up = vcgtq_f32(truncated, x);
+  return(vsubq_f32(truncated, vbslq_f32(rounded_up, vdupq_n_f32(1), vdupq_n_f32(0))));
+}
+
+/**
+ * Reduces each lane with the same steps as the scalar reduce_*
+ * functions: subtract whole periods, then fix a floor one turn off.
+ */
+
+static inline float32x4_t reduce_lanes(float32x4_t x, float offset, float period, float low){
+  float32x4_t periods = floor_lanes(vmulq_n_f32(vaddq_f32(x, vdupq_n_f32(offset)), 1.0f/period));
+  float32x4_t reduced = vmlsq_n_f32(x, periods, period);
+  uint32x4_t below = vcltq_f32(reduced, vdupq_n_f32(low));
+  reduced = vbslq_f32(below, vaddq_f32(reduced, vdupq_n_f32(period)), reduced);
+  uint32x4_t above = vcgeq_f32(reduced, vdupq_n_f32(low+period));
+  return(vbslq_f32(above, vsubq_f32(reduced, vdupq_n_f32(period)), reduced));
+}
+#endif
+
+/**
+ * fast_sincos() over an array. With NEON each group of four is
+ * reduced and evaluated at once, using selects and sign-bit flips in
+ * place of the scalar branches; any leftover elements go through the
+ * scalar version.
+ * 
+ * @param x Angles in radians.
+ * @param sin_x Output sines, may not overlap x.
+ * @param cos_x Output cosines, may not overlap x.
+ * @param count Number of elements.
+ */
+
+void fast_sincos_batch(const float *x, float *sin_x, float *cos_x, int count){
+  int i = 0;
+#ifdef FAST_MATH_NEON
+  for(; i+4 <= count; i += 4){
+    float32x4_t v = vld1q_f32(x+i);
+    int32x4_t k = round_to_int(vmulq_n_f32(v, two_over_pi));
+    float32x4_t kf = vcvtq_f32_s32(k);
+    float32x4_t r = vmlsq_n_f32(vmlsq_n_f32(vmlsq_n_f32(v, kf, pio2_1), kf, pio2_2), kf, pio2_3);
+    float32x4_t r2 = vmulq_f32(r, r);
+    float32x4_t s = vmlaq_f32(vdupq_n_f32(sin_c2), r2, vdupq_n_f32(sin_c3));
+    s = vmlaq_f32(vdupq_n_f32(sin_c1), r2, s);
+    s = vmlaq_f32(r, vmulq_f32(r, r2), s);
+    float32x4_t c = vmlaq_f32(vdupq_n_f32(cos_c2), r2, vdupq_n_f32(cos_c3));
+    c = vmlaq_f32(vdupq_n_f32(cos_c1), r2, c);
+    c = vmlaq_f32(vmlsq_n_f32(vdupq_n_f32(1), r2, 0.5f), vmulq_f32(r2, r2), c);
+    uint32x4_t swap = vtstq_s32(k, vdupq_n_s32(1));
+    float32x4_t sin_value = vbslq_f32(swap, c, s);
+    float32x4_t cos_value = vbslq_f32(swap, s, c);
+    uint32x4_t sin_sign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(k), vdupq_n_u32(2)), 30);
+    uint32x4_t cos_sign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(vaddq_s32(k, vdupq_n_s32(1))), vdupq_n_u32(2)), 30);
+    vst1q_f32(sin_x+i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(sin_value), sin_sign)));
+    vst1q_f32(cos_x+i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(cos_value), cos_sign)));
+  }
+#endif
+  for(; i < count; i++){
+    fast_sincos(x[i], sin_x[i], cos_x[i]);
+  }
+}
+
+/**
+ * reduce_0_to_360() over an array, in place.
+ * 
+ * @param angles Angles in degrees.
+ * @param count Number of elements.
+ */
+
+void reduce_0_to_360_batch(float *angles, int count){
+  int i = 0;
+#ifdef FAST_MATH_NEON
+  for(; i+4 <= count; i += 4){
+    vst1q_f32(angles+i, reduce_lanes(vld1q_f32(angles+i), 0, 360, 0));
+  }
+#endif
+  for(; i < count; i++){
+    angles[i] = reduce_0_to_360(angles[i]);
+  }
+}
+
+/**
+ * reduce_negative_180_to_180() over an array, in place.
+ * 
+ * @param angles Angles in degrees.
+ * @param count Number of elements.
+ */
+
+void reduce_negative_180_to_180_batch(float *angles, int count){
+  int i = 0;
+#ifdef FAST_MATH_NEON
+  for(; i+4 <= count; i += 4){
+    vst1q_f32(angles+i, reduce_lanes(vld1q_f32(angles+i), 180, 360, -180));
+  }
+#endif
+  for(; i < count; i++){
+    angles[i] = reduce_negative_180_to_180(angles[i]);
+  }
+}
@@ -0,0 +1,115 @@
+#include "vex.h"
+
+Feedforward::Feedforward(){};
+
+/**
+ * Feedforward constructor.
+ * 
+ * @param kS Volts to overcome static friction.
+ * @param kV Volts per unit of velocity.
+ * @param kA Volts per unit of acceleration.
+ */
+
+Feedforward::Feedforward(float kS, float kV, float kA) :
+  kS(kS),
+  kV(kV),
+  kA(kA)
+{};
+
+/**
+ * Voltage needed to follow a velocity and acceleration. kS is applied
+ * in the direction of travel, or of acceleration when starting from
+ * rest.
+ * 
+ * @param velocity Desired velocity.
+ * @param acceleration Desired acceleration.
+ * @return Feedforward voltage.
+ */
+
+float Feedforward::calculate(float velocity, float acceleration){
+  float direction = velocity != 0 ? velocity : acceleration;
+  float static_voltage = 0;
+  if (direction > 0){ static_voltage = kS; }
+  if (direction < 0){ static_voltage = -kS; }
+  return(static_voltage + kV*velocity + kA*acceleration);
+}
+
+/**
+ * Fastest velocity that leaves enough voltage to still accelerate at
+ * the given rate, for planning profiles inside what the battery can
+ * deliver.
+ * 
+ * @param voltage Voltage available.
+ * @param acceleration Acceleration to keep in reserve.
+ * @return Velocity limit, 0 if even starting needs more voltage.
+ */
+
+float Feedforward::max_velocity(float voltage, float acceleration){
+  if (kV <= 0){
+    return(INFINITY);
+  }
+  return(fmax(0, (voltage-kS-kA*acceleration)/kV));
+}
+
+/**
+ * Adds one sample to the fit. Samples with the robot stopped tell
+ * nothing about kS's sign and should be left out by the caller.
+ * 
+ * @param voltage Voltage applied.
+ * @param velocity Measured velocity.
+ * @param acceleration Measured acceleration.
+ */
+
+void FeedforwardFit::add_sample(float voltage, float velocity, float acceleration){
+  double x[3] = {(double)(velocity > 0 ? 1 : -1), velocity, acceleration};
+  for(int i = 0; i < 3; i++){
+    for(int j = 0; j < 3; j++){
+      sums[i][j] += x[i]*x[j];
+    }
+    targets[i] += x[i]*voltage;
+  }
+  sample_count++;
+}
+
+/**
+ * Solves the normal equations by Gaussian elimination.
+ * 
+ * @param result Set to the fitted constants on success.
+ * @return False if there weren't enough distinct samples for a fit.
+ */
+
+bool FeedforwardFit::solve(Feedforward &result){
+  if (sample_count < 3){
+    return(false);
+  }
+  double m[3][4];
+  for(int i = 0; i < 3; i++){
+    for(int j = 0; j < 3; j++){
+      m[i][j] = sums[i][j];
+    }
+    m[i][3] = targets[i];
+  }
+  for(int col = 0; col < 3; col++){
+    int pivot = col;
+    for(int row = col+1; row < 3; row++){
+      if (fabs(m[row][col]) > fabs(m[pivot][col])){ pivot = row; }
+    }
+    if (fabs(m[pivot][col]) < 1e-9){
+      return(false);
+    }
+    for(int j = 0; j < 4; j++){
+      std::swap(m[col][j], m[pivot][j]);
+    }
+    for(int row = 0; row < 3; row++){
+      if (row == col){ continue; }
+      double factor = m[row][col]/m[col][col];
+      for(int j = col; j < 4; j++){
+        m[row][j] -= factor*m[col][j];
+      }
+    }
+  }
+  result.kS = m[0][3]/m[0][0];
+  result.kV = m[1][3]/m[1][1];
+  result.kA = m[2][3]/m[2][2];
+  return(true);
+}
@@ -0,0 +1,42 @@
+#include "vex.h"
+
+/**
+ * Interpolates the constants for a move.
+ * 
+ * @param size Distance or angle left to go, either sign.
+ * @param speed Speed at the start of the move, in units per second.
+ * @param max_acceleration How hard the drive can brake, in units per second squared. 0 ignores speed.
+ * @return Constants for the move, with size set to the effective size used.
+ */
+
+GainPoint GainSchedule::lookup(float size, float speed, float max_acceleration) const {
+  float effective_size = fabs(size);
+  if (max_acceleration > 0){
+    effective_size += speed*speed/(2*max_acceleration);
+  }
+  if (count == 1 || effective_size <= points[0].size){
+    GainPoint result = points[0];
+    result.size = effective_size;
+    return(result);
+  }
+  int upper = 1;
+  while (upper < count-1 && points[upper].size < effective_size){
+    upper++;
+  }
+  const GainPoint &a = points[upper-1];
+  const GainPoint &b = points[upper];
+  float t = (effective_size-a.size)/(b.size-a.size);
+  if (t > 1){
+    t = 1;
+  }
+  GainPoint result;
+  result.size = effective_size;
+  result.max_voltage = a.max_voltage + (b.max_voltage-a.max_voltage)*t;
+  result.kp = a.kp + (b.kp-a.kp)*t;
+  result.ki = a.ki + (b.ki-a.ki)*t;
+  result.kd = a.kd + (b.kd-a.kd)*t;
+  result.starti = a.starti + (b.starti-a.starti)*t;
+  result.settle_error = a.settle_error + (b.settle_error-a.settle_error)*t;
+  result.settle_time = a.settle_time + (b.settle_time-a.settle_time)*t;
+  return(result);
+}
@@ -0,0 +1,68 @@
+#include "vex.h"
+
+/**
+ * Loop timer constructor.
+ * 
+ * @param period Loop period in milliseconds, e.g. 10 for 100Hz or 5 for 200Hz.
+ */
+
+LoopTimer::LoopTimer(float period) :
+  period(period)
+{};
+
+/**
+ * Restarts the schedule from now and clears the jitter statistics.
+ * Call this right before entering the loop.
+ */
+
+void LoopTimer::start(){
+  start_time_us = vex::timer::systemHighResolution();
+  next_deadline_us = start_time_us;
+  tick_time_us = start_time_us;
+  last_jitter_us = 0;
+  max_jitter_us = 0;
+  tick_count = 0;
+  missed_ticks = 0;
+}
+
+/**
+ * Sleeps until the next deadline, which is always a whole number of
+ * periods after start(). If an iteration overran by a full period or
+ * more, the missed ticks are counted and the schedule restarts from
+ * now rather than running a burst of back-to-back iterations.
+ * A late tick still yields once, so a loop running over budget can't
+ * starve lower-priority tasks under the cooperative scheduler.
+ * The time it actually woke up is kept in tick_time_us.
+ */
+
+void LoopTimer::wait(){
+  uint64_t period_us = period*1000;
+  next_deadline_us += period_us;
+  uint64_t now_us = vex::timer::systemHighResolution();
+  if(now_us < next_deadline_us){
+    vex::task::sleep((next_deadline_us-now_us+999)/1000);
+  } else {
+    vex::task::yield();
+  }
+  now_us = vex::timer::systemHighResolution();
+  last_jitter_us = (int32_t)(now_us-next_deadline_us);
+  if(last_jitter_us > max_jitter_us){
+    max_jitter_us = last_jitter_us;
+  }
+  if(now_us >= next_deadline_us+period_us){
+    missed_ticks += (now_us-next_deadline_us)/period_us;
+    next_deadline_us = now_us;
+  }
+  tick_time_us = now_us;
+  tick_count++;
+}
+
+/**
+ * Time since start() on the loop's clock.
+ * 
+ * @return Elapsed time in milliseconds.
+ */
+
+float LoopTimer::elapsed_ms(){
+  return (vex::timer::systemHighResolution()-start_time_us)/1000.0;
+}
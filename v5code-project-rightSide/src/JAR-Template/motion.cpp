@@ -0,0 +1,123 @@
+#include "vex.h"
+
+/**
+ * Motion handle constructor. Handles are returned by Drive, there
+ * is no need to make one directly.
+ * 
+ * @param drive Chassis running the motion.
+ * @param id Motion id the handle refers to.
+ */
+
+Motion::Motion(Drive *drive, int id) :
+  drive(drive),
+  id(id)
+{};
+
+/**
+ * Whether the motion has finished. A handle to an older motion
+ * counts as done once a newer one has started.
+ * 
+ * @return True once the motion's task has exited.
+ */
+
+bool Motion::is_done(){
+  return(drive->motion.id != id || !drive->motion.running);
+}
+
+/**
+ * Error the motion's loop saw on its latest tick.
+ * 
+ * @return Remaining error in inches or degrees, 0 once done.
+ */
+
+float Motion::remaining_error(){
+  if (is_done()){
+    return(0);
+  }
+  return(drive->motion.error);
+}
+
+/**
+ * How far the motion has gone toward its target, measured as the
+ * drop in error since it started.
+ * 
+ * @return Distance traveled in inches or degrees.
+ */
+
+float Motion::traveled(){
+  if (drive->motion.id != id || !drive->motion.started){
+    return(0);
+  }
+  float start_error = drive->motion.start_error;
+  float traveled = start_error-drive->motion.error;
+  if (start_error < 0){
+    traveled = -traveled;
+  }
+  return(traveled);
+}
+
+/**
+ * Traveled distance as a fraction of the starting error.
+ * 
+ * @return Fraction traveled, 0 until the loop starts, 1 once done.
+ */
+
+float Motion::fraction_traveled(){
+  if (is_done()){
+    return(1);
+  }
+  if (!drive->motion.started){
+    return(0);
+  }
+  float start_error = fabs(drive->motion.start_error);
+  if (start_error == 0){
+    return(1);
+  }
+  return(traveled()/start_error);
+}
+
+/**
+ * Blocks until the motion has settled, timed out or been cancelled.
+ */
+
+void Motion::wait(){
+  while(!is_done()){
+    vex::task::sleep(5);
+  }
+}
+
+/**
+ * Blocks until the motion has traveled far enough or finished.
+ * Use this to fire intake or pneumatic actions part way through.
+ * 
+ * @param traveled Distance in inches or degrees from the start.
+ */
+
+void Motion::wait_until(float traveled){
+  while(!is_done() && this->traveled() < traveled){
+    vex::task::sleep(5);
+  }
+}
+
+/**
+ * Blocks until a fraction of the motion is done or it finishes.
+ * 
+ * @param fraction Fraction of the starting error, from 0 to 1.
+ */
+
+void Motion::wait_until_fraction(float fraction){
+  while(!is_done() && fraction_traveled() < fraction){
+    vex::task::sleep(5);
+  }
+}
+
+/**
+ * Ends the motion early. Its loop exits on the next tick and stops
+ * the drive the same way it would after settling.
+ */
+
+void Motion::cancel(){
+  if (!is_done()){
+    drive->motion.cancelled = true;
+  }
+}
@@ -0,0 +1,101 @@
+#include "vex.h"
+
+uint32_t MotorCommand::total_sent = 0;
+uint32_t MotorCommand::total_saved = 0;
+
+MotorCommand::MotorCommand(motor &single) :
+  single(&single)
+{};
+
+MotorCommand::MotorCommand(motor_group &group) :
+  group(&group),
+  motor_count(group.count())
+{};
+
+/**
+ * Decides whether a command has to go out, and counts it as sent or
+ * saved.
+ * 
+ * @param command Kind of command.
+ * @param voltage Voltage for COMMAND_VOLTAGE.
+ * @param mode Brake mode for COMMAND_BRAKE.
+ * @return True if it has to be sent.
+ */
+
+bool MotorCommand::needs_send(command_type command, float voltage, brakeType mode){
+  uint32_t now = vex::timer::system();
+  bool changed = command != last_command ||
+    (command == COMMAND_VOLTAGE && fabs(voltage-last_voltage) > voltage_tolerance) ||
+    (command == COMMAND_BRAKE && mode != last_brake);
+  if (!changed && now-last_sent_ms < keep_alive_ms){
+    saved += motor_count;
+    total_saved += motor_count;
+    return(false);
+  }
+  last_command = command;
+  last_voltage = voltage;
+  last_brake = mode;
+  last_sent_ms = now;
+  sent += motor_count;
+  total_sent += motor_count;
+  return(true);
+}
+
+/**
+ * Spins at a voltage, negative for reverse.
+ * 
+ * @param voltage Voltage from -12 to 12.
+ */
+
+void MotorCommand::spin(float voltage){
+  if (!needs_send(COMMAND_VOLTAGE, voltage, last_brake)){
+    return;
+  }
+  if (group != nullptr){
+    group->spin(fwd, voltage, volt);
+  } else {
+    single->spin(fwd, voltage, volt);
+  }
+}
+
+/**
+ * Stops with the motor's own brake mode.
+ */
+
+void MotorCommand::stop(){
+  if (!needs_send(COMMAND_STOP, 0, last_brake)){
+    return;
+  }
+  if (group != nullptr){
+    group->stop();
+  } else {
+    single->stop();
+  }
+}
+
+/**
+ * Stops with a given brake mode.
+ * 
+ * @param mode Brake mode.
+ */
+
+void MotorCommand::stop(brakeType mode){
+  if (!needs_send(COMMAND_BRAKE, 0, mode)){
+    return;
+  }
+  if (group != nullptr){
+    group->stop(mode);
+  } else {
+    single->stop(mode);
+  }
+}
+
+/**
+ * Forgets the last command, so the next one goes out whatever it is.
+ * Call it when something else has been driving the motor directly,
+ * like an auton before usercontrol starts.
+ */
+
+void MotorCommand::invalidate(){
+  last_command = COMMAND_NONE;
+}
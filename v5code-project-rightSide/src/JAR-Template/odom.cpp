@@ -18,6 +18,14 @@ void Odom::set_physical_distances(float ForwardTracker_center_distance, float Si
   this->SidewaysTracker_center_distance = SidewaysTracker_center_distance;
 }
 
+float Odom::get_ForwardTracker_center_distance(){
+  return(ForwardTracker_center_distance);
+}
+
+float Odom::get_SidewaysTracker_center_distance(){
+  return(SidewaysTracker_center_distance);
+}
+
 /**
  * Resets the position, including tracking wheels.
  * Position is field-centric, and orientation is such that 0 degrees
@@ -37,6 +45,7 @@ void Odom::set_position(float X_position, float Y_position, float orientation_de
   this->X_position = X_position;
   this->Y_position = Y_position;
   this->orientation_deg = orientation_deg;
+  publish_pose();
 }
 
 /**
@@ -45,6 +54,8 @@ void Odom::set_position(float X_position, float Y_position, float orientation_de
  * All the deltas are done by getting member variables and comparing them to 
  * the input. Ultimately this all works to update the public member variable
  * X_position. This function needs to be run at 200Hz or so for best results.
+ * Set method to PILONS_ARC to use this version; the default ROTATED_ARC
+ * hands off to update_position_rotated().
  * 
  * @param ForwardTracker_position Current position of the sensor in inches.
  * @param SidewaysTracker_position Current position of the sensor in inches.
@@ -52,6 +63,10 @@ void Odom::set_position(float X_position, float Y_position, float orientation_de
  */
 
 void Odom::update_position(float ForwardTracker_position, float SidewaysTracker_position, float orientation_deg){
+  if (method == ROTATED_ARC){
+    update_position_rotated(ForwardTracker_position, SidewaysTracker_position, orientation_deg);
+    return;
+  }
   // this-> always refers to the old version of the variable, so subtracting this->x from x gives delta x.
   float Forward_delta = ForwardTracker_position-this->ForwardTracker_position;
   float Sideways_delta = SidewaysTracker_position-this->SideWaysTracker_position;
@@ -91,4 +106,91 @@ void Odom::update_position(float ForwardTracker_position, float SidewaysTracker_
 
   X_position+=X_position_delta;
   Y_position+=Y_position_delta;
+  publish_pose();
+}
+
+/**
+ * Same arc model as update_position()'s Pilons version, computed
+ * without the polar round trip. The chord the robot moved along is
+ * rotated straight into field coordinates by the heading halfway
+ * through the step, which is what the atan2/sqrt/cos/sin sequence
+ * works out to. Single precision throughout, with a series for the
+ * chord scale instead of a sin and a branch on zero.
+ * The heading change is wrapped to [-180, 180], so crossing 0 degrees
+ * doesn't drop that step's motion.
+ * 
+ * @param ForwardTracker_position Current position of the sensor in inches.
+ * @param SidewaysTracker_position Current position of the sensor in inches.
+ * @param orientation_deg Field-centered, clockwise-positive, orientation.
+ */
+
+void Odom::update_position_rotated(float ForwardTracker_position, float SidewaysTracker_position, float orientation_deg){
+  float Forward_delta = ForwardTracker_position-this->ForwardTracker_position;
+  float Sideways_delta = SidewaysTracker_position-this->SideWaysTracker_position;
+  this->ForwardTracker_position = ForwardTracker_position;
+  this->SideWaysTracker_position = SidewaysTracker_position;
+  const float deg_to_rad = (float)M_PI/180.0f;
+  float prev_orientation_rad = this->orientation_deg*deg_to_rad;
+  // Headings come in as [0, 360), so a step across 0 would otherwise
+  // look like almost a full turn the other way.
+  float orientation_delta_deg = orientation_deg-this->orientation_deg;
+  if (orientation_delta_deg > 180.0f){ orientation_delta_deg -= 360.0f; }
+  if (orientation_delta_deg < -180.0f){ orientation_delta_deg += 360.0f; }
+  float orientation_delta_rad = orientation_delta_deg*deg_to_rad;
+  this->orientation_deg = orientation_deg;
+
+  // chord_scale is 2*sin(delta/2)/delta = sin(h)/h with h = delta/2,
+  // which goes to 1 as delta goes to 0. The wrap above keeps |h| <=
+  // pi/2, where its Taylor series through h^10 is within 4e-8, so one
+  // polynomial covers every step with no branch and no division.
+  float half_delta = 0.5f*orientation_delta_rad;
+  float h2 = half_delta*half_delta;
+  float chord_scale = 1.0f+h2*(-1.0f/6.0f+h2*(1.0f/120.0f+h2*(-1.0f/5040.0f+h2*(1.0f/362880.0f+h2*(-1.0f/39916800.0f)))));
+  float chord_sin = orientation_delta_rad*chord_scale;
+  float local_X_position = Sideways_delta*chord_scale + SidewaysTracker_center_distance*chord_sin;
+  float local_Y_position = Forward_delta*chord_scale + ForwardTracker_center_distance*chord_sin;
+
+  float average_orientation_rad = prev_orientation_rad+half_delta;
+  float sin_orientation, cos_orientation;
+  fast_sincos(average_orientation_rad, sin_orientation, cos_orientation);
+  X_position += local_X_position*cos_orientation + local_Y_position*sin_orientation;
+  Y_position += local_Y_position*cos_orientation - local_X_position*sin_orientation;
+  publish_pose();
+}
+
+/**
+ * Publishes the current pose for readers in other tasks. The writer
+ * fills whichever buffer readers aren't pointed at, then bumps the
+ * sequence number to flip them over, so it never waits on a reader.
+ * The fields X_position, Y_position and orientation_deg are the
+ * odom task's working copy and shouldn't be read from other tasks.
+ */
+
+void Odom::publish_pose(){
+  uint32_t sequence = pose_sequence.load(std::memory_order_relaxed);
+  OdomPose &pose = published_poses[(sequence+1)&1];
+  pose.X_position = X_position;
+  pose.Y_position = Y_position;
+  pose.orientation_deg = orientation_deg;
+  pose.time_us = vex::timer::systemHighResolution();
+  pose_sequence.store(sequence+1, std::memory_order_release);
+}
+
+/**
+ * Gets the latest published pose as one consistent tuple. If the
+ * writer published again while it was being copied, the copy is
+ * retried, so readers never block the odom task.
+ * 
+ * @return The latest pose with its timestamp.
+ */
+
+OdomPose Odom::get_pose(){
+  while(true){
+    uint32_t sequence = pose_sequence.load(std::memory_order_acquire);
+    OdomPose pose = published_poses[sequence&1];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (pose_sequence.load(std::memory_order_relaxed) == sequence){
+      return(pose);
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "vex.h"
+
+Path::Path(){};
+
+/**
+ * Builds a path from parallel arrays of coordinates, e.g.
+ * const float xs[] = {0, 0, 24}; const float ys[] = {0, 24, 48};
+ * Path path(xs, ys, 3);
+ * Points past max_waypoints are dropped.
+ * 
+ * @param X_positions Waypoint x positions in inches.
+ * @param Y_positions Waypoint y positions in inches.
+ * @param count Number of waypoints.
+ */
+
+Path::Path(const float *X_positions, const float *Y_positions, int count){
+  for(int i = 0; i < count; i++){
+    add_point(X_positions[i], Y_positions[i]);
+  }
+};
+
+/**
+ * Appends a waypoint and extends the path length.
+ * 
+ * @param X_position Waypoint x position in inches.
+ * @param Y_position Waypoint y position in inches.
+ * @return False if the path is full.
+ */
+
+bool Path::add_point(float X_position, float Y_position){
+  if (count >= max_waypoints){
+    return(false);
+  }
+  this->X_position[count] = X_position;
+  this->Y_position[count] = Y_position;
+  if (count > 0){
+    length += hypot(X_position-this->X_position[count-1], Y_position-this->Y_position[count-1]);
+  }
+  distance[count] = length;
+  count++;
+  return(true);
+}
+
+/**
+ * Finds the point on the path closest to a position, looking only at
+ * a window of segments from start_segment on. The follower passes the
+ * last result back in, so progress never jumps backward onto an
+ * earlier part of a path that crosses itself.
+ * 
+ * @param X_position Robot x position in inches.
+ * @param Y_position Robot y position in inches.
+ * @param start_segment First segment to check.
+ * @param search_segments How many segments to check.
+ * @param progress Set to the distance along the path of the closest point.
+ * @return Index of the segment holding the closest point.
+ */
+
+int Path::closest_segment(float X_position, float Y_position, int start_segment, int search_segments, float &progress){
+  int best_segment = start_segment;
+  float best_distance_sq = INFINITY;
+  progress = distance[start_segment];
+  int end_segment = std::min(count-1, start_segment+search_segments);
+  for(int i = start_segment; i < end_segment; i++){
+    float segment_X = this->X_position[i+1]-this->X_position[i];
+    float segment_Y = this->Y_position[i+1]-this->Y_position[i];
+    float segment_length = distance[i+1]-distance[i];
+    float t = 0;
+    if (segment_length > 0){
+      t = ((X_position-this->X_position[i])*segment_X + (Y_position-this->Y_position[i])*segment_Y)/(segment_length*segment_length);
+      t = clamp(t, 0, 1);
+    }
+    float dX = this->X_position[i]+t*segment_X-X_position;
+    float dY = this->Y_position[i]+t*segment_Y-Y_position;
+    float distance_sq = dX*dX+dY*dY;
+    if (distance_sq < best_distance_sq){
+      best_distance_sq = distance_sq;
+      best_segment = i;
+      progress = distance[i]+t*segment_length;
+    }
+  }
+  return(best_segment);
+}
+
+/**
+ * Interpolates the point a given distance along the path. Distances
+ * past either end give the end point.
+ * 
+ * @param path_distance Distance along the path in inches.
+ * @param start_segment Segment to start scanning forward from.
+ * @param X_position Set to the point's x position.
+ * @param Y_position Set to the point's y position.
+ * @return Index of the segment holding the point.
+ */
+
+int Path::point_at(float path_distance, int start_segment, float &X_position, float &Y_position){
+  if (path_distance >= length){
+    X_position = this->X_position[count-1];
+    Y_position = this->Y_position[count-1];
+    return(std::max(count-2, 0));
+  }
+  int i = std::max(start_segment, 0);
+  while(i < count-2 && distance[i+1] < path_distance){
+    i++;
+  }
+  float segment_length = distance[i+1]-distance[i];
+  float t = segment_length > 0 ? clamp((path_distance-distance[i])/segment_length, 0, 1) : 0;
+  X_position = this->X_position[i]+t*(this->X_position[i+1]-this->X_position[i]);
+  Y_position = this->Y_position[i]+t*(this->Y_position[i+1]-this->Y_position[i]);
+  return(i);
+}
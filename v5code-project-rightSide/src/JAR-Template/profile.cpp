@@ -0,0 +1,93 @@
+#include "vex.h"
+
+/**
+ * Plans a profile. Units are up to the caller, inches and seconds for
+ * drives or degrees and seconds for turns.
+ * 
+ * @param distance Signed length of the move.
+ * @param max_velocity Cruise velocity limit.
+ * @param max_acceleration Acceleration limit, the peak for S-curves.
+ * @param s_curve True for half-cosine ramps, false for trapezoidal ones.
+ */
+
+MotionProfile::MotionProfile(float distance, float max_velocity, float max_acceleration, bool s_curve) :
+  distance(distance),
+  s_curve(s_curve)
+{
+  // A half-cosine ramp takes pi/2 times as long as a constant one to
+  // reach the same speed with the same peak acceleration. Either way
+  // a ramp covers peak_velocity*ramp_time/2.
+  float ramp_scale = s_curve ? M_PI/2.0 : 1.0;
+  float length = fabs(distance);
+  peak_velocity = max_velocity;
+  if (ramp_scale*max_velocity*max_velocity/max_acceleration > length){
+    peak_velocity = sqrt(length*max_acceleration/ramp_scale);
+  }
+  ramp_time = ramp_scale*peak_velocity/max_acceleration;
+  if (peak_velocity > 0){
+    cruise_time = (length-peak_velocity*ramp_time)/peak_velocity;
+  }
+  if (cruise_time < 0){
+    cruise_time = 0;
+  }
+  duration = 2*ramp_time+cruise_time;
+};
+
+/**
+ * Updates position, velocity and acceleration to their setpoints at
+ * the given time. Before 0 the profile is at rest at the start, and
+ * after duration it's at rest on the target.
+ * 
+ * @param time Seconds since the move started.
+ */
+
+void MotionProfile::sample(float time){
+  float length = fabs(distance);
+  float direction = distance < 0 ? -1 : 1;
+  float ramp_distance = peak_velocity*ramp_time/2.0;
+
+  // Time into whichever ramp we're on, counted from the stopped end.
+  float ramp_t = 0;
+  bool decelerating = false;
+  if (time <= 0){
+    position = 0; velocity = 0; acceleration = 0;
+    return;
+  }
+  if (time >= duration){
+    position = distance; velocity = 0; acceleration = 0;
+    return;
+  }
+  if (time < ramp_time){
+    ramp_t = time;
+  } else if (time < ramp_time+cruise_time){
+    position = direction*(ramp_distance+peak_velocity*(time-ramp_time));
+    velocity = direction*peak_velocity;
+    acceleration = 0;
+    return;
+  } else {
+    ramp_t = duration-time;
+    decelerating = true;
+  }
+
+  float ramp_position, ramp_velocity, ramp_acceleration;
+  if (s_curve){
+    float w = M_PI/ramp_time;
+    ramp_position = peak_velocity/2.0*(ramp_t-sin(w*ramp_t)/w);
+    ramp_velocity = peak_velocity/2.0*(1-cos(w*ramp_t));
+    ramp_acceleration = peak_velocity/2.0*w*sin(w*ramp_t);
+  } else {
+    float a = peak_velocity/ramp_time;
+    ramp_position = a*ramp_t*ramp_t/2.0;
+    ramp_velocity = a*ramp_t;
+    ramp_acceleration = a;
+  }
+
+  if (decelerating){
+    position = direction*(length-ramp_position);
+    acceleration = -direction*ramp_acceleration;
+  } else {
+    position = direction*ramp_position;
+    acceleration = direction*ramp_acceleration;
+  }
+  velocity = direction*ramp_velocity;
+}
@@ -0,0 +1,175 @@
+#include "vex.h"
+
+SDLog::SDLog(const char *filename){
+  strncpy(this->filename, filename, sizeof(this->filename)-1);
+  this->filename[sizeof(this->filename)-1] = 0;
+}
+
+/**
+ * Adds a channel to every sample. Channels have to be added before
+ * the first sample or record, since the header lists them.
+ * 
+ * @param name Column name, which must outlive the log.
+ * @param scale Resolution to store the channel at, e.g. 0.01 for hundredths.
+ * @return Index to pass to set(), or -1 if there's no room.
+ */
+
+int SDLog::add_channel(const char *name, float scale){
+  if (header_written || channel_count >= max_channels){
+    return(-1);
+  }
+  channel_names[channel_count] = name;
+  channel_scales[channel_count] = scale;
+  channel_values[channel_count] = 0;
+  previous_values[channel_count] = 0;
+  return(channel_count++);
+}
+
+/**
+ * Sets a channel's value for the next sample. Values are rounded to
+ * the channel's scale, and ones that can't be stored (NaN, or more
+ * than 2^30 counts) are clamped.
+ * 
+ * @param channel Index from add_channel().
+ * @param value Value in the channel's units.
+ */
+
+void SDLog::set(int channel, float value){
+  if (channel < 0 || channel >= channel_count){
+    return;
+  }
+  float counts = value/channel_scales[channel];
+  if (!(counts > -1073741824.0f)){ counts = (counts != counts) ? 0 : -1073741824.0f; }
+  if (counts > 1073741824.0f){ counts = 1073741824.0f; }
+  channel_values[channel] = (int32_t)lroundf(counts);
+}
+
+/**
+ * Appends one sample of every channel, as changes from the last one.
+ * 
+ * @param time_us Time of the sample in microseconds.
+ */
+
+void SDLog::write_sample(uint32_t time_us){
+  write_header();
+  make_room(1+5+5*channel_count);
+  put_byte(SD_LOG_SAMPLE);
+  put_time(time_us);
+  for(int i = 0; i < channel_count; i++){
+    put_signed((uint32_t)channel_values[i]-(uint32_t)previous_values[i]);
+    previous_values[i] = channel_values[i];
+  }
+  rows_written++;
+}
+
+/**
+ * Appends a telemetry record, so settle events and PID ticks land in
+ * the same file as the samples around them.
+ * 
+ * @param record Record from Telemetry.
+ */
+
+void SDLog::write_record(const TelemetryRecord &record){
+  write_header();
+  make_room(1+5+3+2+8);
+  put_byte(SD_LOG_RECORD);
+  put_time(record.time_us);
+  put_varint(record.motion_id);
+  put_byte(record.type);
+  put_byte(record.state);
+  put_float(record.error);
+  put_float(record.output);
+}
+
+/**
+ * Writes whatever is buffered to the SD card. The first write starts
+ * the file over; later ones append. Writes fail quietly (and are
+ * counted) with no card, so a match never stops for the log. Until a
+ * write succeeds the file has no header, so a failed first write
+ * starts the log over, and the next frame writes the header again.
+ */
+
+void SDLog::flush(){
+  if (buffer_length == 0){
+    return;
+  }
+  int32_t written;
+  if (bytes_written == 0){
+    written = Brain.SDcard.savefile(filename, buffer, buffer_length);
+  } else {
+    written = Brain.SDcard.appendfile(filename, buffer, buffer_length);
+  }
+  if (written == buffer_length){
+    bytes_written += buffer_length;
+  } else {
+    failed_writes++;
+    if (bytes_written == 0){
+      header_written = false;
+      previous_time_us = 0;
+      for(int i = 0; i < channel_count; i++){
+        previous_values[i] = 0;
+      }
+    }
+  }
+  buffer_length = 0;
+}
+
+void SDLog::make_room(int length){
+  if (buffer_length+length > buffer_size){
+    flush();
+  }
+}
+
+void SDLog::put_byte(uint8_t value){
+  buffer[buffer_length++] = value;
+}
+
+void SDLog::put_varint(uint32_t value){
+  while(value >= 0x80){
+    put_byte((uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  put_byte((uint8_t)value);
+}
+
+void SDLog::put_signed(uint32_t value){
+  put_varint((value << 1) ^ (uint32_t)((int32_t)value >> 31));
+}
+
+void SDLog::put_float(float value){
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for(int i = 0; i < 4; i++){
+    put_byte((uint8_t)(bits >> (8*i)));
+  }
+}
+
+void SDLog::put_time(uint32_t time_us){
+  put_signed(time_us-previous_time_us);
+  previous_time_us = time_us;
+}
+
+void SDLog::write_header(){
+  if (header_written){
+    return;
+  }
+  int length = 4+1+5;
+  for(int i = 0; i < channel_count; i++){
+    length += strlen(channel_names[i])+1+4;
+  }
+  make_room(length);
+  header_written = true;
+  put_byte('J');
+  put_byte('L');
+  put_byte('O');
+  put_byte('G');
+  put_byte(SD_LOG_VERSION);
+  put_varint(channel_count);
+  for(int i = 0; i < channel_count; i++){
+    for(const char *c = channel_names[i]; *c; c++){
+      put_byte(*c);
+    }
+    put_byte(0);
+    put_float(channel_scales[i]);
+  }
+}
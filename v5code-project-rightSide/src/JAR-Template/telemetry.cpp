@@ -0,0 +1,152 @@
+#include "vex.h"
+
+Telemetry telemetry;
+
+static_assert(sizeof(TelemetryRecord) == 16, "TelemetryRecord should pack into 16 bytes");
+
+Telemetry::Telemetry(){
+  for(uint32_t i = 0; i < capacity; i++){
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * Appends a record without blocking. A writer claims the next index
+ * with a compare-exchange, fills in that slot, and then publishes it
+ * by advancing the slot's sequence, which is what the reader checks.
+ * 
+ * @param type What the record is.
+ * @param state Settle state for PID ticks, or the part number.
+ * @param error Controller error, or the value of a mark.
+ * @param output Controller output.
+ * @param time_us Time of the record in microseconds.
+ * @return False if the queue was full and the record was dropped.
+ */
+
+bool Telemetry::log(telemetry_type type, uint8_t state, float error, float output, uint64_t time_us){
+  uint32_t index = write_index.load(std::memory_order_relaxed);
+  Slot *slot;
+  while(true){
+    slot = &slots[index & (capacity-1)];
+    int32_t lag = (int32_t)(slot->sequence.load(std::memory_order_acquire) - index);
+    if (lag == 0){
+      if (write_index.compare_exchange_weak(index, index+1, std::memory_order_relaxed)){ break; }
+    } else if (lag < 0){
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return(false);
+    } else {
+      index = write_index.load(std::memory_order_relaxed);
+    }
+  }
+  slot->record.time_us = (uint32_t)time_us;
+  slot->record.motion_id = motion_id.load(std::memory_order_relaxed);
+  slot->record.type = type;
+  slot->record.state = state;
+  slot->record.error = error;
+  slot->record.output = output;
+  slot->sequence.store(index+1, std::memory_order_release);
+  return(true);
+}
+
+bool Telemetry::log(telemetry_type type, uint8_t state, float error, float output){
+  return(log(type, state, error, output, vex::timer::systemHighResolution()));
+}
+
+/**
+ * Logs a checkpoint from an auton, in place of printing it.
+ * 
+ * @param value Anything that identifies the checkpoint.
+ */
+
+void Telemetry::mark(float value){
+  log(TELEMETRY_MARK, SETTLE_RUNNING, value, 0);
+}
+
+/**
+ * Takes the oldest record off the queue. Only one task may read.
+ * 
+ * @param record Set to the record if there was one.
+ * @return False if the queue was empty.
+ */
+
+bool Telemetry::pop(TelemetryRecord &record){
+  Slot &slot = slots[read_index & (capacity-1)];
+  if (slot.sequence.load(std::memory_order_acquire) != read_index+1){
+    return(false);
+  }
+  record = slot.record;
+  slot.sequence.store(read_index+capacity, std::memory_order_release);
+  read_index++;
+  return(true);
+}
+
+/**
+ * Pops every record currently queued and hands each to sink.
+ * 
+ * @param sink Function to receive the records.
+ * @return Number of records drained.
+ */
+
+int Telemetry::drain(void (*sink)(const TelemetryRecord &record)){
+  TelemetryRecord record;
+  int count = 0;
+  while(pop(record)){
+    sink(record);
+    count++;
+  }
+  return(count);
+}
+
+/**
+ * Starts the low-priority task that drains the queue to the console.
+ * Call it once, like set_coordinates() starts odom.
+ */
+
+void Telemetry::start(){
+  drain_task = vex::task(drain_task_entry, this, vex::task::taskPriorityLow);
+}
+
+/**
+ * Prints a record the way the code used to print it directly, so
+ * settle events still read "timeout reached" and marks print their
+ * number. Only jams print unless verbose is set.
+ * 
+ * @param record Record to print.
+ */
+
+void Telemetry::print(const TelemetryRecord &record){
+  switch(record.type){
+    case TELEMETRY_SETTLED:
+      if (telemetry.verbose){
+        if (record.state == SETTLE_TIMEOUT){ printf("timeout reached\n"); }
+        if (record.state == SETTLE_TIME){ printf("settle_time reached\n"); }
+        if (record.state == SETTLE_FLAGS){ printf("settle_flags reached\n"); }
+        if (record.state == SETTLE_VELOCITY){ printf("settle_velocity reached\n"); }
+      }
+      break;
+    case TELEMETRY_MARK:
+      if (telemetry.verbose){ printf("%g\n", record.error); }
+      break;
+    case TELEMETRY_INTAKE_JAM:
+      printf("intake jam on roller %d\n", record.state);
+      break;
+    case TELEMETRY_PID_TICK:
+    case TELEMETRY_AUX_PID_TICK:
+      if (telemetry.verbose){
+        printf("%lu %u %s %d %.3f %.3f\n", (unsigned long)record.time_us, record.motion_id,
+          record.type == TELEMETRY_PID_TICK ? "pid" : "aux", record.state, record.error, record.output);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+int Telemetry::drain_task_entry(void *telemetry){
+  Telemetry *self = (Telemetry*)telemetry;
+  while(true){
+    self->drain(print);
+    vex::task::sleep(self->drain_period);
+  }
+  return(0);
+}
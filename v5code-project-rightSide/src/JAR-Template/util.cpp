@@ -2,17 +2,19 @@
 
 /**
  * Converts an angle to an equivalent one in the range [0, 360).
+ * Takes the same time for any input, so the unbounded IMU rotation()
+ * can be passed straight in. The floor can land one turn off when
+ * angle/360 rounds onto a whole number, which the last two lines fix.
  * 
  * @param angle The angle to be reduced in degrees.
  * @return Reduced angle.
  */
 
 float reduce_0_to_360(float angle) {
-  while(!(angle >= 0 && angle < 360)) {
-    if( angle < 0 ) { angle += 360; }
-    if(angle >= 360) { angle -= 360; }
-  }
-  return(angle);
+  float reduced = angle - 360.0f*floorf(angle*(1/360.0f));
+  if (reduced < 0) { reduced += 360.0f; }
+  if (reduced >= 360.0f) { reduced -= 360.0f; }
+  return(reduced);
 }
 
 /**
@@ -23,11 +25,10 @@ float reduce_0_to_360(float angle) {
  */
 
 float reduce_negative_180_to_180(float angle) {
-  while(!(angle >= -180 && angle < 180)) {
-    if( angle < -180 ) { angle += 360; }
-    if(angle >= 180) { angle -= 360; }
-  }
-  return(angle);
+  float reduced = angle - 360.0f*floorf((angle+180.0f)*(1/360.0f));
+  if (reduced < -180.0f) { reduced += 360.0f; }
+  if (reduced >= 180.0f) { reduced -= 360.0f; }
+  return(reduced);
 }
 
 /**
@@ -40,11 +41,10 @@ float reduce_negative_180_to_180(float angle) {
  */
 
 float reduce_negative_90_to_90(float angle) {
-  while(!(angle >= -90 && angle < 90)) {
-    if( angle < -90 ) { angle += 180; }
-    if(angle >= 90) { angle -= 180; }
-  }
-  return(angle);
+  float reduced = angle - 180.0f*floorf((angle+90.0f)*(1/180.0f));
+  if (reduced < -90.0f) { reduced += 180.0f; }
+  if (reduced >= 90.0f) { reduced -= 180.0f; }
+  return(reduced);
 }
 
 /**
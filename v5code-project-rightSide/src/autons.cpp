@@ -1,6 +1,51 @@
 #include "vex.h"
 #include <iostream>
 using namespace std;
+
+/**
+ * Gain schedules for drive_distance(), turn_to_angle() and the swings,
+ * so short and long moves each get constants tuned for their size
+ * instead of one set for everything. Calls that pass their own gains
+ * still use those. Run build/sim/pid_tuner --schedule to retune them.
+ * They come from the simulator only, so default_constants() leaves
+ * them off until they've been checked on the robot.
+ */
+
+constexpr GainPoint drive_gains[] = {
+  // size, maxVoltage, kP, kI, kD, startI, settle_error, settle_time
+  {2, 7.25, 17.96, 0, 61.29, 0, 1.5, 300},
+  {6, 11.8, 9.996, 0.01875, 53.31, 1.75, 1.5, 300},
+  {24, 11.5, 4.21, 0, 29.68, 0, 1.5, 300},
+  {48, 12, 3.098, 0, 21.24, 0, 1.5, 300},
+};
+constexpr GainPoint turn_gains[] = {
+  // size, maxVoltage, kP, kI, kD, startI, settle_error, settle_time
+  {15, 9, 2.452, 0, 7.744, 0, 1, 300},
+  {45, 11, 0.8735, 0, 3.75, 0, 1, 300},
+  {90, 9, 1.092, 0, 5.859, 0, 1, 300},
+  {180, 10.2, 0.5748, 0, 3.547, 0, 1, 300},
+};
+constexpr GainPoint swing_gains[] = {
+  // size, maxVoltage, kP, kI, kD, startI, settle_error, settle_time
+  {45, 9.88, 0.4688, 0, 2, 13.59, 1, 300},
+  {90, 11.8, 0.4021, 0.00075, 1.918, 6.562, 1, 300},
+};
+constexpr GainSchedule drive_schedule(drive_gains);
+constexpr GainSchedule turn_schedule(turn_gains);
+constexpr GainSchedule swing_schedule(swing_gains);
+static_assert(drive_schedule.is_sorted() && turn_schedule.is_sorted() && swing_schedule.is_sorted(), "gain schedule rows must be in increasing size");
+
+/**
+ * Driver control stick curves, worked out at compile time. Both keep
+ * the old deadband of 5. Throttle is a light cubic blend, and turning
+ * gets more of the cube so small turns for lining up on a goal are
+ * easier to hit. They're off by default, so driving stays linear until
+ * a driver opts in by passing them to set_joystick_curves().
+ */
+
+constexpr JoystickCurve throttle_curve = JoystickCurve::cubic(5, 0.3);
+constexpr JoystickCurve turn_curve = JoystickCurve::cubic(5, 0.6);
+
 /**
  * Resets the constants for auton movement.
  * Modify these to change the default behavior of functions like
@@ -20,6 +65,47 @@ void default_constants(){
   chassis.set_drive_exit_conditions(1.5, 300, 5000);
   chassis.set_turn_exit_conditions(1, 300, 3000);
   chassis.set_swing_exit_conditions(1, 300, 3000);
+
+  // Each settle velocity set is in the form of (drive, turn, swing), in
+  // inches or degrees per second. A motion inside its settle error and
+  // slower than this ends without waiting out the settle time.
+  chassis.set_settle_velocities(1, 5, 5);
+
+  // Each profile set is in the form of (max_velocity, max_acceleration),
+  // in inches or degrees per second. Used by the *_profiled motions.
+  chassis.set_drive_profile(70, 250);
+  chassis.set_turn_profile(500, 2500);
+  chassis.profile_s_curve = false;
+
+  // Pure pursuit lookahead in inches, for follow_path(). Needs a drive
+  // setup with odom.
+  chassis.path_lookahead = 10;
+
+  // Each feedforward set is in the form of (kS, kV, kA). Run
+  // characterization_test() to measure them.
+  chassis.set_drive_feedforward(0.32, 0.146, 0.016);
+  chassis.set_turn_feedforward(0.65, 0.0148, 0.0017);
+
+  // Control loop period in milliseconds (10 is 100Hz, 5 is 200Hz).
+  chassis.set_loop_period(10);
+
+  // Derivative low-pass weight, 0 leaves the D term unfiltered.
+  chassis.set_derivative_filter(0);
+
+  // Battery voltage at full charge, which voltage commands are relative
+  // to. Below it commands are scaled up so speeds don't drop as it
+  // drains; a full battery is never scaled down.
+  battery.set_nominal_voltage(12.8);
+
+  // Gain schedules by move size, nullptr to use the constant sets above.
+  // A later set_*_constants() call turns its schedule back off.
+  chassis.set_drive_schedule(nullptr);
+  chassis.set_turn_schedule(nullptr);
+  chassis.set_swing_schedule(nullptr);
+
+  // Driver control stick curves, nullptr for a plain deadband. Pass
+  // &throttle_curve and &turn_curve to opt in to the curves above.
+  chassis.set_joystick_curves(nullptr, nullptr);
 }
 
 /**
@@ -82,6 +168,54 @@ void full_test(){
   chassis.turn_to_angle(0);
 }
 
+/**
+ * The same moves as drive_test() and turn_test() on motion profiles.
+ * Should end where it started, facing the start angle.
+ */
+
+void profiled_test(){
+  chassis.drive_distance_profiled(6);
+  chassis.drive_distance_profiled(12);
+  chassis.drive_distance_profiled(18);
+  chassis.drive_distance_profiled(-36);
+  chassis.turn_to_angle_profiled(5);
+  chassis.turn_to_angle_profiled(30);
+  chassis.turn_to_angle_profiled(90);
+  chassis.turn_to_angle_profiled(225);
+  chassis.turn_to_angle_profiled(0);
+}
+
+/**
+ * Measures the drive and turn feedforward constants and prints them
+ * to the terminal and Brain screen, ready to paste into
+ * default_constants(). Drives about 3 feet forward and back, then
+ * spins in place both ways.
+ */
+
+void characterization_test(){
+  chassis.characterize_drive();
+  chassis.characterize_turn();
+}
+
+/**
+ * Runs the intake while driving instead of after. The rollers start
+ * halfway through the first drive and stop three quarters of the way
+ * back; it should end where it started.
+ */
+
+void async_test(){
+  Motion drive = chassis.drive_distance_async(24);
+  drive.wait_until(12);
+  intake.set(INTAKE_BUCKET, 12);
+  drive.wait();
+  chassis.turn_to_angle_async(180);
+  Motion back = chassis.drive_distance_async(24);
+  back.wait_until_fraction(0.75);
+  intake.stop();
+  back.wait();
+  chassis.turn_to_angle_async(0).wait();
+}
+
 /**
  * Doesn't drive the robot, but just prints coordinates to the Brain screen 
  * so you can check if they are accurate to life. Push the robot around and
@@ -115,6 +249,25 @@ void tank_odom_test(){
   chassis.turn_to_angle(0);
 }
 
+/**
+ * Follows an S-shaped path out without stopping at the waypoints, then
+ * backs along the same path to the start.
+ */
+
+void path_test(){
+  odom_constants();
+  chassis.set_coordinates(0, 0, 0);
+  const float X_positions[] = {0, 0, 12, 24, 24};
+  const float Y_positions[] = {0, 12, 24, 36, 48};
+  Path out(X_positions, Y_positions, 5);
+  chassis.follow_path(out);
+  const float back_X_positions[] = {24, 24, 12, 0, 0};
+  const float back_Y_positions[] = {48, 36, 24, 12, 0};
+  Path back(back_X_positions, back_Y_positions, 5);
+  chassis.follow_path(back, chassis.path_lookahead, 0, true);
+  chassis.turn_to_angle(0);
+}
+
 /**
  * Drives in a square while making a full turn in the process. Should
  * end where it started.
@@ -151,28 +304,24 @@ void AWP_solo()
   chassis.drive_distance(43, 270, 8, 2.5, 1, 300, 1200); 
 
   //score on the long goal
-  topRoller.spin(fwd,12,voltageUnits::volt); 
-  wait(0.4,sec);
-  topRoller.stop();
+  intake.runFor(INTAKE_PUSH_TOP, 12, 400);
+  intake.wait();
 
   //drive to the 3 balls on the right side
   chassis.drive_distance(-16, 270, 12, 6, 1, 300, 650); 
   chassis.turn_to_angle(224,12,1,300,400);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(26, 224, 12, 6, 1, 300, 800); 
   //chassis.drive_distance(18, 224, 1.7, 6, 1, 300, 1700); 
   chassis.drive_distance(18, 224, 2, 6, 1, 300, 1700);
-  bottomRoller.stop();
-  middleRoller.stop();
+  intake.stop();
   chassis.drive_distance(15, 224, 6, 6, 1, 300, 800);
 
   // score on the low center goal
-  middleRoller.spin(fwd,5,voltageUnits::volt);
-  bottomRoller.spin(vex::reverse,5,voltageUnits::volt); 
+  intake.set(INTAKE_OUTTAKE_LOWER_CENTER, 5);
   wait(1.7, sec);
 
   //back out (moved to line 188)
@@ -182,21 +331,17 @@ void AWP_solo()
   // drive to the 3 balls on the left side
   chassis.set_heading_constants(6, .6, 0, 1, 0);
   chassis.drive_distance(36, 180, 10, 6, 1, 300, 1200);
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  // pick up the 3 balls
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);  // pick up the 3 balls
   chassis.drive_distance(16, 180, 1.7, 6, 1, 300, 2000);
   
   //turn and drive to upper center goal
   chassis.turn_to_angle(321, 12, 1, 300, 600);
   
-  bottomRoller.stop();
-  middleRoller.stop();
+  intake.stop();
   chassis.drive_distance(16, 321, 6, 6, 1, 300, 750);
 
   // shoot into upper center
-  bottomRoller.spin(fwd,7,voltageUnits::volt);
-  middleRoller.spin(fwd,10,voltageUnits::volt);
-  topRoller.spin(vex::reverse,7,voltageUnits::volt);
+  intake.set(INTAKE_SCORE_UPPER_CENTER, 10);
   int finishTime = Brain.Timer.time();
   int timeUsed = finishTime-startTime;
   cout<<"time used = "<<timeUsed<<endl;
@@ -220,17 +365,15 @@ void rightSide_v1()
     chassis.drive_distance(20.7, 270, 6, 6, 1, 300, 1700);
     
     //score on top goal
-    topRoller.spin(fwd,10,voltageUnits::volt); 
-    wait(0.4,sec);
-    topRoller.stop();
+    intake.runFor(INTAKE_PUSH_TOP, 10, 400);
+    intake.wait();
   
     //drive to the 3 balls on the right side
     chassis.drive_distance(-14.5, 270, 6, 6, 1, 300, 1000); 
     chassis.turn_to_angle(224,6,1,300,600);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(24, 224, 6, 6, 1, 300, 800); 
   chassis.drive_distance(19, 224, 2, 6, 1, 300, 1700); 
@@ -239,12 +382,8 @@ void rightSide_v1()
   chassis.drive_distance(10, 224, 3, 6, 1, 300, 1000);
 
   // score on the low center goal
-  middleRoller.spin(fwd,5,voltageUnits::volt);
-  bottomRoller.spin(vex::reverse,5,voltageUnits::volt); 
-  wait(4, sec);
-
-  middleRoller.stop();
-  bottomRoller.stop();
+  intake.runFor(INTAKE_OUTTAKE_LOWER_CENTER, 5, 4000);
+  intake.wait();
   int finishTime = Brain.Timer.time();
   int timeUsed = finishTime-startTime;
   cout<<"time used = "<<timeUsed<<endl;
@@ -271,59 +410,48 @@ void leftSide_v1()
     chassis.drive_distance(21, 90, 8, 6, 1, 300, 850);
     
     //score on top goal
-    topRoller.spin(fwd,12,voltageUnits::volt); 
-    wait(0.4,sec);
-    topRoller.stop();
+    intake.runFor(INTAKE_PUSH_TOP, 12, 400);
+    intake.wait();
     
 
     //drive to the 3 balls 
   chassis.drive_distance(-15, 90, 6, 6, 1, 300, 700); 
-  cout<<"4\n";
+  telemetry.mark(4);
   chassis.turn_to_angle(136,6,1,300,600);
-  cout<<"5\n";
+  telemetry.mark(5);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(25, 136, 6, 6, 1, 300, 800);
-  cout<<"6\n"; 
+  telemetry.mark(6);
   chassis.drive_distance(10, 136, 1.7, 6, 1, 300, 1300); 
-  cout<<"7\n";
+  telemetry.mark(7);
   chassis.drive_distance(16, 136, 5, 6, 1, 300, 800);
 
   // score on the high center goal
-  bottomRoller.spin(fwd,6.5,voltageUnits::volt);
-  middleRoller.spin(fwd,9,voltageUnits::volt);
-  topRoller.spin(vex::reverse,6.5,voltageUnits::volt);
-  wait(1.5, sec);
-  topRoller.stop();
-  middleRoller.stop();
-  bottomRoller.stop();
+  intake.runFor(INTAKE_SCORE_UPPER_CENTER, 9, 1500);
+  intake.wait();
 
   //drive backwards to the matchloader
   chassis.drive_distance(-50, 136, 10, 6, 1, 300, 1200);
     
   chassis.turn_to_angle(-90, 6, 1, 300, 600);
   diddy.set(true);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,9,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 9);
   chassis.drive_distance(13, -90, 3, 6, 1, 300, 800);
 //  chassis.drive_distance(-1, -90, 10, 9, 1, 300, 200);
 //  chassis.drive_distance(1, -90, 10, 9, 1, 300, 200);
   wait(0.5, sec);
   chassis.drive_distance(-13, -90, 6, 6, 1, 300, 800);
-  cout<<"1\n";
+  telemetry.mark(1);
   diddy.set(false);
-  bottomRoller.stop();
-  middleRoller.stop();
+  intake.stop();
   
   chassis.turn_to_angle(90, 6, 1, 300, 800);
   chassis.drive_distance(12, 90, 8, 6, 1, 300, 1000);
-    cout<<"2\n";
-  bottomRoller.spin(fwd,9,voltageUnits::volt);
-  middleRoller.spin(fwd,12,voltageUnits::volt);
-  topRoller.spin(fwd,12,voltageUnits::volt);
+    telemetry.mark(2);
+  intake.set(INTAKE_SCORE_LONG);
 
 
   int finishTime = Brain.Timer.time();
@@ -346,8 +474,7 @@ void leftSide()
   chassis.drive_distance(34, 0, 8, 6, 1, 300, 1200, 1.0, 0, 10, 0, 0.4, 0, 1, 0 );
   chassis.turn_to_angle(-90, 6, 1, 300, 750);
   diddy.set(true);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,9,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 9);
   chassis.drive_distance(8.5, -90, 3, 6, 1, 300, 700);
   chassis.drive_distance(-2, -90, 12, 6, 1, 300, 250);
   chassis.drive_distance(2, -90, 12, 6, 1, 300, 250);
@@ -360,39 +487,29 @@ void leftSide()
   //score to the long goal
   chassis.turn_to_angle(90, 6, 1, 300, 850);
   chassis.drive_distance(13, 90, 8, 6, 1, 300, 800);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);
-  middleRoller.spin(fwd,12,voltageUnits::volt);
-  topRoller.spin(fwd,12,voltageUnits::volt);
-  wait(2.0,sec);
-  bottomRoller.stop();
-  middleRoller.stop();
-  topRoller.stop();
+  intake.runFor(INTAKE_SCORE_LONG, 12, 2000);
+  intake.wait();
 
   //back out and turn to the 3
 
   chassis.drive_distance(-16, 90, 6, 6, 1, 300, 700); 
-  cout<<"4\n";
+  telemetry.mark(4);
   chassis.turn_to_angle(136,6,1,300,700);
-  cout<<"5\n";
+  telemetry.mark(5);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(25, 136, 6, 6, 1, 300, 800);
-  cout<<"6\n"; 
+  telemetry.mark(6);
   chassis.drive_distance(10, 136, 1.7, 6, 1, 300, 1300); 
-  cout<<"7\n";
+  telemetry.mark(7);
   chassis.drive_distance(16, 136, 5, 6, 1, 300, 700);
 
   // score on the high center goal
-  bottomRoller.spin(fwd,6.5,voltageUnits::volt);
-  middleRoller.spin(fwd,9,voltageUnits::volt);
-  topRoller.spin(vex::reverse,6.5,voltageUnits::volt);
+  intake.set(INTAKE_SCORE_UPPER_CENTER, 9);
 /*  wait(1.5, sec);
-  topRoller.stop();
-  middleRoller.stop();
-  bottomRoller.stop();*/
+  intake.stop();*/
 
   int finishTime = Brain.Timer.time();
   int timeUsed = finishTime-startTime;
@@ -415,17 +532,15 @@ void matchLoadtest() {
     chassis.drive_distance(20.7, 270, 6, 6, 1, 300, 800);
     
     //score on top goal
-    topRoller.spin(fwd,9,voltageUnits::volt); 
-    wait(0.3,sec);
-    topRoller.stop();
+    intake.runFor(INTAKE_PUSH_TOP, 9, 300);
+    intake.wait();
   
     //drive to the 3 balls on the right side
     chassis.drive_distance(-14.5, 270, 6, 6, 1, 300, 600); 
     chassis.turn_to_angle(224,6,1,300,600);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(24, 224, 6, 6, 1, 300, 800); 
   chassis.drive_distance(19, 224, 1.7, 6, 1, 300, 1700); 
@@ -434,19 +549,14 @@ void matchLoadtest() {
   chassis.drive_distance(12.5, 224, 3, 6, 1, 300, 1400);
 
   // score on the low center goal
-  middleRoller.spin(fwd,5,voltageUnits::volt);
-  bottomRoller.spin(vex::reverse,5,voltageUnits::volt); 
-  wait(2, sec);
-
-  middleRoller.stop();
-  bottomRoller.stop();
+  intake.runFor(INTAKE_OUTTAKE_LOWER_CENTER, 5, 2000);
+  intake.wait();
   
 
   chassis.drive_distance(-52, 224, 6, 6, 1, 300, 3500);
   chassis.turn_to_angle(90, 6, 1, 300, 600);
   diddy.set(true);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);  
-  middleRoller.spin(vex::reverse,9,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 9);
 
   chassis.drive_distance(13, 90, 3, 6, 1, 300, 2300);
   chassis.drive_distance(-13, 90, 3, 6, 1, 300, 1500);
@@ -471,8 +581,7 @@ void rightSide() {
   chassis.drive_distance(34, 0, 8, 6, 1, 300, 1200, 1.0, 0, 10, 0, 0.4, 0, 1, 0 );
   chassis.turn_to_angle(90, 6, 1, 300, 750);
   diddy.set(true);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);
-  middleRoller.spin(vex::reverse,9,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 9);
   chassis.drive_distance(8.5, 90, 3, 6, 1, 300, 700);
   chassis.drive_distance(-2, 90, 12, 6, 1, 300, 250);
   chassis.drive_distance(2, 90, 12, 6, 1, 300, 250);
@@ -485,39 +594,29 @@ void rightSide() {
   //score to the long goal
   chassis.turn_to_angle(-90, 6, 1, 300, 850);
   chassis.drive_distance(13, -90, 8, 6, 1, 300, 800);
-  bottomRoller.spin(fwd,9,voltageUnits::volt);
-  middleRoller.spin(fwd,12,voltageUnits::volt);
-  topRoller.spin(fwd,12,voltageUnits::volt);
-  wait(2.0,sec);
-  bottomRoller.stop();
-  middleRoller.stop();
-  topRoller.stop();
+  intake.runFor(INTAKE_SCORE_LONG, 12, 2000);
+  intake.wait();
 
   //back out and turn to the 3
 
   chassis.drive_distance(-14, -90, 6, 6, 1, 300, 700);
-  cout<<"4\n";
+  telemetry.mark(4);
   chassis.turn_to_angle(-136,6,1,300,700);
-  cout<<"5\n";
+  telemetry.mark(5);
 
   // pick up the 3 balls
-  bottomRoller.spin(fwd,12,voltageUnits::volt);
-  middleRoller.spin(vex::reverse,12,voltageUnits::volt);
+  intake.set(INTAKE_BUCKET, 12);
 
   chassis.drive_distance(25, -136, 6, 6, 1, 300, 800);
-  cout<<"6\n";
+  telemetry.mark(6);
   chassis.drive_distance(10, -136, 1.7, 6, 1, 300, 1300);
-  cout<<"7\n";
+  telemetry.mark(7);
   chassis.drive_distance(16, -136, 5, 6, 1, 300, 700);
 
   // score on the high center goal
-  bottomRoller.spin(fwd,6.5,voltageUnits::volt);
-  middleRoller.spin(fwd,9,voltageUnits::volt);
-  topRoller.spin(vex::reverse,6.5,voltageUnits::volt);
+  intake.set(INTAKE_SCORE_UPPER_CENTER, 9);
 /*  wait(1.5, sec);
-  topRoller.stop();
-  middleRoller.stop();
-  bottomRoller.stop();*/
+  intake.stop();*/
 
   int finishTime = Brain.Timer.time();
   int timeUsed = finishTime-startTime;
@@ -525,7 +624,32 @@ void rightSide() {
 }
 
 void FlagTest() {
-  chassis.turn_to_angle(90, 6, 1, 300, 700, 15) // 15 flags
-  chassis.drive_distance(10, 45, 6, 6, 1, 300, 700, 15) //also 15 flags
+  chassis.turn_to_angle(90, 6, 1, 300, 700, 15); // 15 flags
+  chassis.drive_distance(10, 45, 6, 6, 1, 300, 700, 15); //also 15 flags
   // add more tests
-}
\ No newline at end of file
+}
+
+/**
+ * The autons the selector and the simulator know, match autons first.
+ * Add new autons here to make them selectable. odom_test,
+ * tank_odom_test, holonomic_odom_test and path_test need an odom drive
+ * setup, which the robot doesn't have (ZERO_TRACKER_NO_ODOM), so
+ * they're left out.
+ */
+
+const AutonEntry auton_registry[] = {
+  {"AWP_solo", AWP_solo},
+  {"leftSide", leftSide},
+  {"rightSide", rightSide},
+  {"matchLoadtest", matchLoadtest},
+  {"FlagTest", FlagTest},
+  {"drive_test", drive_test},
+  {"turn_test", turn_test},
+  {"swing_test", swing_test},
+  {"full_test", full_test},
+  {"async_test", async_test},
+  {"profiled_test", profiled_test},
+  {"characterization_test", characterization_test},
+};
+
+const int auton_count = sizeof(auton_registry)/sizeof(auton_registry[0]);
\ No newline at end of file
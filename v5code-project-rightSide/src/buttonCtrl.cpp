@@ -2,30 +2,20 @@
 
 #include "vex.h"
 
-//print each motor temperature on the brain
+//print each motor temperature on the brain, with how far it's derated.
+//the motor health task already has the readings, so this doesn't wait
+//on the motors
 void printTemps() 
 {     
-   Brain.Screen.clearScreen();
-  Brain.Screen.print(" fl T=");
-  Brain.Screen.print(fl.temperature(celsius));
-  Brain.Screen.print(" ml T=");
-  Brain.Screen.print(ml.temperature(celsius));
-  Brain.Screen.print(" bl T=");
-  Brain.Screen.print(bl.temperature(celsius));
-  Brain.Screen.newLine();
-  Brain.Screen.print(" fr T=");
-  Brain.Screen.print(fr.temperature(celsius));
-  Brain.Screen.print(" mr T=");
-  Brain.Screen.print(mr.temperature(celsius));
-  Brain.Screen.print(" br T=");
-  Brain.Screen.print(br.temperature(celsius));
-  Brain.Screen.newLine();
-  Brain.Screen.print(" bottom roller T=");
-  Brain.Screen.print(bottomRoller.temperature(celsius));
-  Brain.Screen.print(" middle roller T=");
-  Brain.Screen.print(middleRoller.temperature(celsius));
-  Brain.Screen.print(" top roller T=");
-  Brain.Screen.print(topRoller.temperature(celsius));
+  Brain.Screen.clearScreen();
+  Brain.Screen.setCursor(1, 1);
+  for(int i = 0; i < motorHealthCount; i++){
+    const MotorHealthState &s = motorHealth[i];
+    Brain.Screen.print(" %s T=%.0f %.0f%%", s.name, s.temperature, s.derating*100);
+    if(i % 3 == 2){
+      Brain.Screen.newLine();
+    }
+  }
 }//end of printTemps()
 
 
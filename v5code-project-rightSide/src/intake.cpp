@@ -0,0 +1,191 @@
+//this file runs the rollers through named modes, for autons and driver control
+
+#include "vex.h"
+
+//how often the intake task checks timed modes and jams and refreshes the motors
+static const int intakePeriod = 5;
+//rollers asked for less than this are too slow to tell a jam from a light load
+static const float jamMinimumVoltage = 2;
+
+//driver control voltages for each mode. autons can scale a mode with
+//set(mode, voltage), which sets the fastest roller and keeps the ratios
+const IntakeModeVoltages intakeModes[INTAKE_MODE_COUNT] = {
+  //name, bottom, middle, top
+  {"stop", 0, 0, 0},
+  {"bucket", 9, -9, 0},
+  {"score_long", 9, 12, 12},
+  {"score_upper_center", 9, 12, -9},
+  {"outtake_lower_center", -9, 9, 0},
+  {"push_top", 0, 0, 12},
+};
+
+Intake intake(bottomRoller, middleRoller, topRoller);
+
+Intake::Intake(motor &bottom, motor &middle, motor &top) :
+  rollers{&bottom, &middle, &top},
+  commands{MotorCommand(bottom), MotorCommand(middle), MotorCommand(top)}
+{}
+
+//stops the rollers and starts the intake task. call it once, like startMatchLog()
+void Intake::start()
+{
+  timed = false;
+  profileStep = -1;
+  jams = 0;
+  for(int i = 0; i < rollerCount; i++){
+    commands[i].invalidate();
+  }
+  change(INTAKE_STOP, 0);
+  intakeTask = task(intakeTaskEntry, this);
+}
+
+//switches to a mode at its driver control voltages
+void Intake::set(intakeMode mode)
+{
+  const IntakeModeVoltages &v = intakeModes[mode];
+  set(mode, fmax(fabs(v.bottom), fmax(fabs(v.middle), fabs(v.top))));
+}
+
+//switches to a mode with its fastest roller at voltage. cancels a runFor()
+void Intake::set(intakeMode mode, float voltage)
+{
+  if(timed){
+    endTimed(SETTLE_RUNNING);
+  }
+  if(mode == this->mode && voltage == this->voltage){
+    return;
+  }
+  change(mode, voltage);
+}
+
+//runs a mode for ms and then stops, without blocking. wait() blocks
+//until it's done, and the auton profiler records it as a step
+void Intake::runFor(intakeMode mode, float voltage, uint32_t ms)
+{
+  set(mode, voltage);
+  profileStep = profiler.begin(intakeModes[mode].name, 0, 0);
+  stopTime = vex::timer::system() + ms;
+  timed = true;
+}
+
+void Intake::stop()
+{
+  set(INTAKE_STOP, 0);
+}
+
+//blocks until a runFor() has finished. stops it right at its deadline
+//instead of on the intake task's next tick
+void Intake::wait()
+{
+  while(timed){
+    if((int32_t)(vex::timer::system()-stopTime) >= 0){
+      endTimed(SETTLE_TIME);
+      change(INTAKE_STOP, 0);
+      return;
+    }
+    task::sleep(1);
+  }
+}
+
+//a new mode also ends any unjam and gets its own spin up time
+void Intake::change(intakeMode mode, float voltage)
+{
+  this->mode = mode;
+  this->voltage = voltage;
+  unjamming = false;
+  spinUpEnd = vex::timer::system() + spinUpTime;
+  for(int i = 0; i < rollerCount; i++){
+    stalledTime[i] = 0;
+  }
+  apply();
+}
+
+void Intake::endTimed(uint8_t reason)
+{
+  timed = false;
+  profiler.end(profileStep, reason, 0, 0, voltage);
+  profileStep = -1;
+}
+
+//voltage the mode asks of one roller, 0 bottom, 1 middle, 2 top
+float Intake::rollerVoltage(int roller)
+{
+  const IntakeModeVoltages &v = intakeModes[mode];
+  float modeVoltages[rollerCount] = {v.bottom, v.middle, v.top};
+  float fastest = fmax(fabs(v.bottom), fmax(fabs(v.middle), fabs(v.top)));
+  if(fastest == 0){
+    return 0;
+  }
+  return modeVoltages[roller]*voltage/fastest;
+}
+
+//counts how long each running roller has been stalled, and starts an
+//unjam once one has been stalled for jamTime
+void Intake::checkJams()
+{
+  if((int32_t)(vex::timer::system()-spinUpEnd) < 0){
+    return;
+  }
+  for(int i = 0; i < rollerCount; i++){
+    if(fabs(rollerVoltage(i)) < jamMinimumVoltage){
+      stalledTime[i] = 0;
+      continue;
+    }
+    float current = rollers[i]->current(amp);
+    bool stalled = fabs(rollers[i]->velocity(rpm)) < jamVelocity && current > jamCurrent;
+    stalledTime[i] = stalled ? stalledTime[i] + intakePeriod : 0;
+    if(stalledTime[i] >= jamTime){
+      jams++;
+      telemetry.log(TELEMETRY_INTAKE_JAM, i, current, rollers[i]->torque(torqueUnits::Nm));
+      unjamming = true;
+      unjamEnd = vex::timer::system() + unjamTime;
+      for(int j = 0; j < rollerCount; j++){
+        stalledTime[j] = 0;
+      }
+      return;
+    }
+  }
+}
+
+//sends the mode to the rollers, or backs them off while unjamming.
+//MotorCommand drops repeats, so calling it every tick only costs the
+//changes and keep-alives
+void Intake::apply()
+{
+  for(int i = 0; i < rollerCount; i++){
+    float v = rollerVoltage(i);
+    if(v == 0){
+      commands[i].stop();
+    } else if(unjamming){
+      commands[i].spin(battery.compensate((v > 0 ? -unjamVoltage : unjamVoltage)*derating[i]));
+    } else {
+      commands[i].spin(battery.compensate(v*derating[i]));
+    }
+  }
+}
+
+int Intake::intakeTaskEntry(void *intake)
+{
+  Intake *self = (Intake*)intake;
+  LoopTimer loop(intakePeriod);
+  loop.start();
+  while(1){
+    uint32_t now = vex::timer::system();
+    if(self->timed && (int32_t)(now-self->stopTime) >= 0){
+      self->endTimed(SETTLE_TIME);
+      self->change(INTAKE_STOP, 0);
+    } else {
+      if(self->unjamming && (int32_t)(now-self->unjamEnd) >= 0){
+        //back to the mode, with time to spin up again
+        self->unjamming = false;
+        self->spinUpEnd = now + self->spinUpTime;
+      }
+      if(!self->unjamming){
+        self->checkJams();
+      }
+      self->apply();
+    }
+    loop.wait();
+  }
+  return 0;
+}
@@ -749,80 +749,45 @@ PORT3,     -PORT4,
 
 );
 
-int current_auton_selection = 0;
 bool auto_started = false;
 int matchLoadOut = false;
 /**
- * Function before autonomous. It prints the current auton number on the screen
- * and tapping the screen cycles the selected auton by 1. Add anything else you
- * may need, like resetting pneumatic components. You can rename these autons to
- * be more descriptive, if you like.
+ * Function before autonomous. It prints the selected auton on the screen,
+ * restored from the SD card, and tapping the right or left side of the
+ * screen selects the next or previous auton in auton_registry. Add anything
+ * else you may need, like resetting pneumatic components. To add an auton,
+ * declare it in autons.h and list it in auton_registry in autons.cpp.
  */
 
 void pre_auton() {
   // Initializing Robot Configuration. DO NOT REMOVE!
   vexcodeInit();
   default_constants();
+  startMatchLog();
+  intake.start();
+  startMotorHealth();
   GaryInertial.calibrate();
   if(GaryInertial.isCalibrating()) {wait(20,msec);}
+  selector.load();
+  Brain.Screen.pressed(AutonSelector::screen_pressed);
   while(!auto_started){
-    Brain.Screen.clearScreen();
-    Brain.Screen.printAt(5, 20, "JAR Template v1.2.0");
-    Brain.Screen.printAt(5, 40, "Battery Percentage:");
-    Brain.Screen.printAt(5, 60, "%d", Brain.Battery.capacity());
-    Brain.Screen.printAt(5, 80, "Chassis Heading Reading:");
-    Brain.Screen.printAt(5, 100, "%f", chassis.get_absolute_heading());
-    Brain.Screen.printAt(5, 120, "Selected Auton:");
-    switch(current_auton_selection){
-      case 0:
-        Brain.Screen.printAt(5, 140, "Auton 1");
-        break;
-      case 1:
-        Brain.Screen.printAt(5, 140, "Auton 2");
-        break;
-      case 2:
-        Brain.Screen.printAt(5, 140, "Auton 3");
-        break;
-      case 3:
-        Brain.Screen.printAt(5, 140, "Auton 4");
-        break;
-      case 4:
-        Brain.Screen.printAt(5, 140, "Auton 5");
-        break;
-      case 5:
-        Brain.Screen.printAt(5, 140, "Auton 6");
-        break;
-      case 6:
-        Brain.Screen.printAt(5, 140, "Auton 7");
-        break;
-      case 7:
-        Brain.Screen.printAt(5, 140, "Auton 8");
-        break;
-    }
-    if(Brain.Screen.pressing()){
-      while(Brain.Screen.pressing()) {}
-      current_auton_selection ++;
-    } else if (current_auton_selection == 8){
-      current_auton_selection = 0;
-    }
-    task::sleep(10);
+    selector.draw();
+    task::sleep(50);
   }
 }
 
 /**
- * Auton function, which runs the selected auton. Case 0 is the default,
- * and will run in the brain screen goes untouched during preauton. Replace
- * drive_test(), for example, with your own auton function you created in
- * autons.cpp and declared in autons.h.
+ * Auton function, which runs the auton picked on the Brain screen during
+ * preauton, or the last one picked if the SD card saved it. Without a
+ * saved choice it runs the first entry in auton_registry.
  */
 
 void autonomous(void) {
   auto_started = true;
-  //AWP_solo(); //slot 2
-  //rightSide();//slot 3
-  //leftSide();//slot4
-  //matchLoadtest(); //slot5
-  FlagTest(); // slot 6?
+  profiler.start();
+  selector.run();
+  profiler.report();
+  flushMatchLog();
 }
 
 /*---------------------------------------------------------------------------*/
@@ -838,6 +803,13 @@ void autonomous(void) {
 
 
 void usercontrol(void) {
+  // Prints the auton's step timings if autonomous ran and was cut off.
+  profiler.report();
+  // Autonomous drove the motors directly, so the first commands always go out.
+  chassis.invalidate_commands();
+  // Held commands cost no port traffic, so the loop can run every 10ms.
+  LoopTimer driverLoop(10);
+  driverLoop.start();
   // User control code here, inside the loop
   while (1) {
     // This is the main execution loop for the user control program.
@@ -856,28 +828,19 @@ void usercontrol(void) {
     chassis.control_tank();
     
     if(Controller1.ButtonR1.pressing()){ //intake and score on long goal
-      bottomRoller.spin(fwd,9,voltageUnits::volt);
-      middleRoller.spin(fwd,12,voltageUnits::volt);
-      topRoller.spin(fwd,12,voltageUnits::volt);
+      intake.set(INTAKE_SCORE_LONG);
     }
     else if(Controller1.ButtonR2.pressing()){ //intake and score on upper center goal
-      bottomRoller.spin(fwd,9,voltageUnits::volt);
-      middleRoller.spin(fwd,12,voltageUnits::volt);
-      topRoller.spin(reverse,9,voltageUnits::volt);
+      intake.set(INTAKE_SCORE_UPPER_CENTER);
     }
     else if(Controller1.ButtonL1.pressing()){ //intake into bucket
-      bottomRoller.spin(fwd,9,voltageUnits::volt);  
-      middleRoller.spin(reverse,9,voltageUnits::volt);
+      intake.set(INTAKE_BUCKET);
     } 
     else if(Controller1.ButtonL2.pressing()){  //outtake to score the lower center goal
-     
-      middleRoller.spin(fwd,9,voltageUnits::volt);
-      bottomRoller.spin(reverse,9,voltageUnits::volt);
+      intake.set(INTAKE_OUTTAKE_LOWER_CENTER);
     }
     else{
-      bottomRoller.stop();
-      middleRoller.stop();
-      topRoller.stop();
+      intake.stop();
     }
   
     
@@ -889,8 +852,8 @@ void usercontrol(void) {
       middleRoller.stop();
     }*/
     
-    wait(20, msec); // Sleep the task for a short amount of time to
-                    // prevent wasted resources.
+    driverLoop.wait(); // Sleep the task until the next tick to
+                       // prevent wasted resources.
   }
   
 }
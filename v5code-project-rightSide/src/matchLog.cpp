@@ -0,0 +1,138 @@
+//this file records every match and practice run to the SD card
+
+#include "vex.h"
+
+//200Hz, the same as odom
+static const int matchLogPeriod = 5;
+//write to the card whenever about 1KB has built up. a row is well
+//under 100 bytes, so no write gets much bigger than this and none
+//holds the log task up for long
+static const int matchLogFlushBytes = 1024;
+//how long flushMatchLog() waits for the log task to write
+static const int matchLogFlushTimeout = 200;
+
+static SDLog matchLog("log_000.jlog");
+static bool matchLogRunning = false;
+//set by flushMatchLog(), cleared by the log task once it has written
+static volatile bool flushRequested = false;
+static task matchLogHandle;
+
+static motor *loggedMotors[] = {&fl, &ml, &bl, &fr, &mr, &br, &bottomRoller, &middleRoller, &topRoller};
+static const char *loggedMotorNames[][3] = {
+  {"fl_deg", "fl_rpm", "fl_amps"},
+  {"ml_deg", "ml_rpm", "ml_amps"},
+  {"bl_deg", "bl_rpm", "bl_amps"},
+  {"fr_deg", "fr_rpm", "fr_amps"},
+  {"mr_deg", "mr_rpm", "mr_amps"},
+  {"br_deg", "br_rpm", "br_amps"},
+  {"bottomRoller_deg", "bottomRoller_rpm", "bottomRoller_amps"},
+  {"middleRoller_deg", "middleRoller_rpm", "middleRoller_amps"},
+  {"topRoller_deg", "topRoller_rpm", "topRoller_amps"},
+};
+static const int loggedMotorCount = sizeof(loggedMotors)/sizeof(loggedMotors[0]);
+
+static int motorChannels[loggedMotorCount][3];
+static int imuChannel, xChannel, yChannel, headingChannel, batteryChannel, droppedChannel, commandsSavedChannel, jamsChannel, hottestChannel, deratingChannel;
+
+//telemetry goes to the card, and still gets printed like before
+static void logRecord(const TelemetryRecord &record)
+{
+  matchLog.write_record(record);
+  Telemetry::print(record);
+}
+
+static int matchLogTask()
+{
+  LoopTimer loop(matchLogPeriod);
+  loop.start();
+  bool wasEnabled = Competition.isEnabled();
+  bool wasAutonomous = Competition.isAutonomous();
+  while(1){
+    for(int i = 0; i < loggedMotorCount; i++){
+      matchLog.set(motorChannels[i][0], loggedMotors[i]->position(deg));
+      matchLog.set(motorChannels[i][1], loggedMotors[i]->velocity(rpm));
+      matchLog.set(motorChannels[i][2], loggedMotors[i]->current(amp));
+    }
+    matchLog.set(imuChannel, GaryInertial.rotation());
+    OdomPose pose = chassis.odom.get_pose();
+    matchLog.set(xChannel, pose.X_position);
+    matchLog.set(yChannel, pose.Y_position);
+    matchLog.set(headingChannel, pose.orientation_deg);
+    matchLog.set(batteryChannel, Brain.Battery.voltage());
+    matchLog.set(droppedChannel, telemetry.dropped);
+    matchLog.set(commandsSavedChannel, MotorCommand::total_saved);
+    matchLog.set(jamsChannel, intake.jams);
+    float hottest = 0;
+    for(int i = 0; i < motorHealthCount; i++){
+      hottest = fmax(hottest, motorHealth[i].temperature);
+    }
+    matchLog.set(hottestChannel, hottest);
+    matchLog.set(deratingChannel, chassis.derating);
+    matchLog.write_sample(vex::timer::systemHighResolution());
+    telemetry.drain(logRecord);
+    //the end of auton and disabling both kill the task that was running,
+    //so the log task writes out what it has when either happens
+    bool enabled = Competition.isEnabled();
+    bool autonomous = Competition.isAutonomous();
+    if(flushRequested || enabled != wasEnabled || autonomous != wasAutonomous || matchLog.buffer_length >= matchLogFlushBytes){
+      matchLog.flush();
+      flushRequested = false;
+    }
+    wasEnabled = enabled;
+    wasAutonomous = autonomous;
+    loop.wait();
+  }
+  return 0;
+}
+
+//starts logging to the next free log_NNN.jlog on the SD card. with no
+//card, telemetry just gets printed like before
+void startMatchLog()
+{
+  if(!Brain.SDcard.isInserted()){
+    matchLogRunning = false;
+    telemetry.start();
+    return;
+  }
+  char filename[32] = "log_000.jlog";
+  for(int i = 0; i < 1000; i++){
+    snprintf(filename, sizeof(filename), "log_%03d.jlog", i);
+    if(!Brain.SDcard.exists(filename)){ break; }
+  }
+  matchLog = SDLog(filename);
+  for(int i = 0; i < loggedMotorCount; i++){
+    motorChannels[i][0] = matchLog.add_channel(loggedMotorNames[i][0], 0.1);
+    motorChannels[i][1] = matchLog.add_channel(loggedMotorNames[i][1], 0.1);
+    motorChannels[i][2] = matchLog.add_channel(loggedMotorNames[i][2], 0.01);
+  }
+  imuChannel = matchLog.add_channel("imu_rotation_deg", 0.01);
+  xChannel = matchLog.add_channel("X_in", 0.01);
+  yChannel = matchLog.add_channel("Y_in", 0.01);
+  headingChannel = matchLog.add_channel("heading_deg", 0.01);
+  batteryChannel = matchLog.add_channel("battery_volts", 0.01);
+  //records lost to a full telemetry queue, which a replay can't reproduce
+  droppedChannel = matchLog.add_channel("telemetry_dropped", 1);
+  //smart port commands driver control didn't have to send
+  commandsSavedChannel = matchLog.add_channel("motor_commands_saved", 1);
+  //roller jams the intake backed off from
+  jamsChannel = matchLog.add_channel("intake_jams", 1);
+  //from the motor health task, which turns the drive down as it heats up
+  hottestChannel = matchLog.add_channel("hottest_motor_c", 0.1);
+  deratingChannel = matchLog.add_channel("drive_derating", 0.01);
+  matchLogRunning = true;
+  matchLogHandle = task(matchLogTask, task::taskPriorityLow);
+}
+
+//has the log task write out anything not on the card yet, and waits
+//for it. the log task is the only reader of the telemetry queue, so
+//this never drains the queue itself. call it from a task
+void flushMatchLog()
+{
+  if(!matchLogRunning){
+    return;
+  }
+  flushRequested = true;
+  for(int waited = 0; flushRequested && waited < matchLogFlushTimeout; waited += matchLogPeriod){
+    task::sleep(matchLogPeriod);
+  }
+}
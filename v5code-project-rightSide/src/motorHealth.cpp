@@ -0,0 +1,89 @@
+//this file watches the motors' temperatures in the background and turns
+//down hot ones before the motor firmware's own thermal limit kicks in
+
+#include "vex.h"
+
+//sampling each motor is a smart port read, so 10Hz at low priority
+static const int motorHealthPeriod = 100;
+static const int motorHealthRowPeriod = 10;
+//derating starts here, and reaches minimumDerating where the firmware
+//would start halving the current limit
+static const float deratingStartTemp = 45;
+static const float deratingFullTemp = 55;
+static const float minimumDerating = 0.6;
+
+static motor *healthMotors[motorHealthCount] = {&fl, &ml, &bl, &fr, &mr, &br, &bottomRoller, &middleRoller, &topRoller};
+static const char *healthMotorNames[motorHealthCount] = {"fl", "ml", "bl", "fr", "mr", "br", "bottom", "middle", "top"};
+static task motorHealthHandle;
+
+MotorHealthState motorHealth[motorHealthCount];
+MotorHealthSample motorHealthHistory[motorHealthHistoryLength][motorHealthCount];
+//rows written since the start, the latest is at (motorHealthRows-1) % motorHealthHistoryLength
+int motorHealthRows = 0;
+
+//fraction of its voltage a motor at this temperature gets. full power
+//until deratingStartTemp, then down in a straight line
+float motorDerating(float temperature)
+{
+  float t = (temperature-deratingStartTemp)/(deratingFullTemp-deratingStartTemp);
+  t = fmax(0, fmin(1, t));
+  return 1 - t*(1-minimumDerating);
+}
+
+static uint8_t packSample(float value, float scale)
+{
+  return (uint8_t)fmax(0, fmin(255, value*scale+0.5f));
+}
+
+static int motorHealthTask()
+{
+  LoopTimer loop(motorHealthPeriod);
+  loop.start();
+  int samples = 0;
+  while(1){
+    for(int i = 0; i < motorHealthCount; i++){
+      MotorHealthState &s = motorHealth[i];
+      s.temperature = healthMotors[i]->temperature(celsius);
+      s.current = healthMotors[i]->current(amp);
+      s.efficiency = healthMotors[i]->efficiency(percent);
+      s.derating = motorDerating(s.temperature);
+    }
+    //the drive is only as strong as its hottest motor. one number for
+    //both sides, so a hot side doesn't pull the robot into a curve
+    float driveDerating = 1;
+    for(int i = 0; i < 6; i++){
+      driveDerating = fmin(driveDerating, motorHealth[i].derating);
+    }
+    chassis.set_derating(driveDerating);
+    for(int i = 0; i < Intake::rollerCount; i++){
+      intake.derating[i] = motorHealth[6+i].derating;
+    }
+    if(samples++ % motorHealthRowPeriod == 0){
+      MotorHealthSample *row = motorHealthHistory[motorHealthRows % motorHealthHistoryLength];
+      for(int i = 0; i < motorHealthCount; i++){
+        row[i].temperature = packSample(motorHealth[i].temperature, 2);
+        row[i].current = packSample(motorHealth[i].current, 10);
+        row[i].efficiency = packSample(motorHealth[i].efficiency, 1);
+        row[i].derating = packSample(motorHealth[i].derating, 100);
+      }
+      motorHealthRows++;
+    }
+    loop.wait();
+  }
+  return 0;
+}
+
+//starts the low priority motor health task, at full power until it has
+//taken its first readings
+void startMotorHealth()
+{
+  for(int i = 0; i < motorHealthCount; i++){
+    motorHealth[i] = {healthMotorNames[i], 0, 0, 0, 1};
+  }
+  motorHealthRows = 0;
+  chassis.set_derating(1);
+  for(int i = 0; i < Intake::rollerCount; i++){
+    intake.derating[i] = 1;
+  }
+  motorHealthHandle = task(motorHealthTask, task::taskPriorityLow);
+}